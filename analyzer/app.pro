@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2015-02-22T00:22:07
+#
+#-------------------------------------------------
+
+QT       += xml core gui network concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = analyzer
+TEMPLATE = app
+
+CONFIG += serialport
+
+SOURCES += main.cpp\
+        mainwindow.cpp \
+    graphcanvas.cpp \
+    graphcursor.cpp \
+    config.cpp \
+    settingsdlg.cpp \
+    bargraph.cpp \
+    scandatamodel.cpp \
+    sweepserver.cpp \
+    monitorbars.cpp \
+    trackcanvas.cpp
+
+HEADERS  += mainwindow.h \
+    graphcanvas.h \
+    graphcursor.h \
+    version.h \
+    config.h \
+    settingsdlg.h \
+    bargraph.h \
+    scandatamodel.h \
+    sweepserver.h \
+    monitorbars.h \
+    trackcanvas.h
+
+FORMS    += mainwindow.ui \
+    settingsdlg.ui
+
+RESOURCES += \
+    analyzer.qrc
+
+include(core/core.pri)
@@ -0,0 +1,49 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bands.h"
+
+namespace Bands
+{
+  const Band table[] =
+  {
+    {"Custom",              0.0,    0.0,   false},
+    {"160m",                1.5,    1.0,   true},
+    {"80m",                 3.5,    3.0,   true},
+    {"40m",                 6.5,    3.0,   true},
+    {"30m",                 9.5,    3.0,   true},
+    {"25m",                 12.0,   2.0,   true},
+    {"20m",                 15.0,   4.0,   true},
+    {"17m",                 18.0,   2.0,   true},
+    {"15m",                 21.0,   4.0,   true},
+    {"12m",                 24.5,   3.0,   true},
+    {"11m (CB)",            27.0,   2.0,   true},
+    {"10m",                 29.5,   3.0,   true},
+    {"8m",                  40.0,   18.0,  true},
+    {"6m",                  51.0,   4.0,   true},
+    {"HF (3-30MHz)",        16.5,   27.0,  false},
+    {"12-10m (25-30MHz)",   27.5,   5.0,   false},
+    {"HF RFID",             13.5,   5.0,   false},
+    {"1-230MHz",            115.5,  229.0, false},
+    {"1.25m (223.5MHz)",    223.5,  3.0,   true},
+    {"70cm (435MHz)",       435.0,  30.0,  true},
+  };
+
+  const int count = sizeof(table)/sizeof(table[0]);
+}
@@ -0,0 +1,38 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BANDS_H
+#define BANDS_H
+
+class Band
+{
+public:
+    const char *name;
+    double centre, span;    //MHz
+    bool survey;            //Part of the band survey
+};
+
+// Presets in the order of the band selector, entry 0 is the custom range
+namespace Bands
+{
+    extern const Band table[];
+    extern const int count;
+}
+
+#endif // BANDS_H
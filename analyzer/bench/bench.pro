@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Benchmarks of the data, codec and drawing paths
+#
+#-------------------------------------------------
+
+QT       += xml core gui
+
+TARGET = analyzer-bench
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+include(../core/core.pri)
@@ -0,0 +1,217 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDomDocument>
+#include <QImage>
+#include <QPainter>
+
+#include "scandata.h"
+#include "graph.h"
+#include "sark_client.h"
+
+static int min_ms = 200;        //Minimum run time of each case
+static volatile double sink;    //Keeps results alive so the work is not optimised away
+
+// Runs f until min_ms has passed and reports the time per call and per point
+template<class F> static void bench(const char *name, int n, F f)
+{
+    QElapsedTimer timer;
+    long iters = 0;
+
+    f();    //Warm up caches and allocations
+    timer.start();
+    do
+    {
+        f();
+        iters++;
+    } while (timer.elapsed() < min_ms);
+    double ns = (double)timer.nsecsElapsed() / iters;
+
+    printf("%-24s %8d %14.1f us %10.2f ns/point\n", name, n, ns/1000.0, ns/n);
+}
+
+// A plausible single resonance across the HF band
+static void make_scan(ScanData &scan, int n)
+{
+    scan.freq_start = 1000000;
+    scan.freq_end = 30000000;
+    scan.SetPointCount(n-1);
+    for (int i=0; i<n; i++)
+    {
+        double t = (double)i/(n-1);
+        scan.points[i].fromZ(scan.freq_start + t*(scan.freq_end-scan.freq_start),
+                             50.0 + 200.0*(t-0.5)*(t-0.5),
+                             400.0*(t-0.5));
+    }
+    scan.UpdateStats();
+}
+
+static void bench_scandata(int n)
+{
+    ScanData scan;
+    make_scan(scan, n);
+
+    bench("ScanData::UpdateStats", n, [&]() {
+        scan.UpdateStats();
+        sink = scan.swr_min_idx;
+    });
+
+    bench("ScanData::toDom", n, [&]() {
+        QDomDocument doc;
+        QDomElement root = doc.createElement("root");
+        doc.appendChild(root);
+        scan.toDom(doc, root);
+        sink = root.childNodes().count();
+    });
+
+    QDomDocument doc;
+    QDomElement root = doc.createElement("root");
+    doc.appendChild(root);
+    scan.toDom(doc, root);
+    QDomElement e = root.firstChildElement("scandata");
+    ScanData other;
+
+    bench("ScanData::fromDom", n, [&]() {
+        other.fromDom(e);
+        sink = other.points.size();
+    });
+}
+
+static void bench_sample(int n)
+{
+    std::vector<Sample> samples(n);
+
+    bench("Sample::fromRaw", n, [&]() {
+        for (int i=0; i<n; i++)
+            samples[i].fromRaw(1.0, 0.1 + 0.8*i/n, 0.5, 0.6);
+        sink = samples[n-1].X;
+    });
+
+    bench("Sample::fromZ", n, [&]() {
+        for (int i=0; i<n; i++)
+            samples[i].fromZ(i, 10.0 + i%200, (i%400) - 200.0);
+        sink = samples[n-1].swr;
+    });
+}
+
+static void bench_codec(int n)
+{
+    std::vector<uint8_t> buf(4*n);
+    std::vector<uint16_t> half(n);
+
+    bench("Int2Buf", n, [&]() {
+        for (int i=0; i<n; i++)
+            Int2Buf(&buf[4*i], 1000000u + i);
+        sink = buf[4*n-1];
+    });
+
+    for (int i=0; i<n; i++)
+        Float2Buf(&buf[4*i], 50.0f + i);
+
+    bench("Buf2Float", n, [&]() {
+        float f, sum = 0;
+        for (int i=0; i<n; i++)
+        {
+            Buf2Float(&f, &buf[4*i]);
+            sum += f;
+        }
+        sink = sum;
+    });
+
+    for (int i=0; i<n; i++)
+        half[i] = Float2Half(1.0f + i%1000);
+
+    bench("Half2Float", n, [&]() {
+        float sum = 0;
+        for (int i=0; i<n; i++)
+            sum += Half2Float(half[i]);
+        sink = sum;
+    });
+}
+
+static void bench_trace(int n)
+{
+    QImage image(1000, 600, QImage::Format_RGB32);
+    Graph graph;
+    GraphScale scale(&graph, GraphScale::pos_left);
+    GraphTrace trace(&graph, &scale);
+
+    graph.SetSize(image.rect());
+    scale.vmin = 1.0;
+    scale.vmax = 10.0;
+    trace.points.resize(n);
+    for (int i=0; i<n; i++)
+        trace.points[i] = 5.0 + 4.0*sin(i*6.2832/n);
+
+    bench("GraphTrace::Draw cold", n, [&]() {
+        QPainter painter(&image);
+        trace.Invalidate();
+        trace.Draw(painter);
+    });
+
+    bench("GraphTrace::Draw cached", n, [&]() {
+        QPainter painter(&image);
+        trace.Draw(painter);
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    //Drawing text on a QImage needs the GUI application, a display does not: use -platform offscreen
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("analyzer-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Timings of the data, codec and drawing paths");
+    parser.addHelpOption();
+
+    QCommandLineOption timeOpt(QStringList() << "t" << "time", "Minimum run time of each case (default 200).", "ms", "200");
+    QCommandLineOption pointsOpt(QStringList() << "n" << "points", "Comma separated point counts (default 101,1001,10001,100001).",
+                                 "list", "101,1001,10001,100001");
+
+    parser.addOption(timeOpt);
+    parser.addOption(pointsOpt);
+    parser.process(app);
+
+    min_ms = parser.value(timeOpt).toInt();
+    QStringList counts = parser.value(pointsOpt).split(',', QString::SkipEmptyParts);
+
+    printf("%-24s %8s %17s %19s\n", "case", "points", "per call", "per point");
+    for (int i=0; i<counts.size(); i++)
+    {
+        int n = counts[i].toInt();
+        if (n < 2)
+            continue;
+
+        bench_scandata(n);
+        bench_sample(n);
+        bench_codec(n);
+        bench_trace(n);
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,350 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+
+#include "calibration.h"
+
+#define CAL_MAGIC   0x53434131      //"SCA1"
+#define CAL_VERSION 1
+#define CAL_POINT_BYTES (8+6*4)     //quint64 frequency and three single precision complex
+#define CAL_MAX_POINTS 100000
+
+// Ideal standards: open = +1, short = -1, load = 0
+void CalTerms::fromStandards(cplx open, cplx shrt, cplx load)
+{
+    cplx a = open - load, b = shrt - load;
+
+    e00 = load;
+    e11 = std::abs(a-b)>0 ? (a+b)/(a-b) : cplx(0);
+    t = a*(1.0-e11);
+}
+
+cplx CalTerms::Correct(cplx gm) const
+{
+    cplx d = gm - e00;
+    return d / (t + e11*d);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Calibration::Calibration()
+{
+    measured[open_std] = measured[short_std] = measured[load_std] = false;
+    active = -1;
+    stamp = 0;
+}
+
+void Calibration::SetGrid(double fstart, double fend, int n)
+{
+    freqs.resize(n);
+    for (int i=0; i<n; i++)
+        freqs[i] = fstart + (fend-fstart)*i/(n>1 ? n-1 : 1);
+
+    for (int s=0; s<3; s++)
+    {
+        gamma[s].clear();
+        measured[s] = false;
+    }
+    cal_terms.clear();
+    grids.clear();
+    active = -1;
+}
+
+void Calibration::SetStandard(standard_t std, const std::vector<cplx> &g)
+{
+    gamma[std] = g;
+    gamma[std].resize(freqs.size());
+    measured[std] = true;
+    grids.clear();  //Interpolated from the old terms
+    active = -1;
+
+    if (IsComplete())
+        Solve();
+}
+
+bool Calibration::IsComplete()
+{
+    return !freqs.empty() && measured[open_std] && measured[short_std] && measured[load_std];
+}
+
+bool Calibration::Covers(double fstart, double fend)
+{
+    return IsComplete() && fstart>=freqs.front() && fend<=freqs.back();
+}
+
+void Calibration::Solve()
+{
+    cal_terms.resize(freqs.size());
+    for (unsigned int i=0; i<freqs.size(); i++)
+        cal_terms[i].fromStandards(gamma[open_std][i], gamma[short_std][i], gamma[load_std][i]);
+}
+
+// Selects the error terms for a sweep grid, interpolating them only for a grid not seen recently
+void Calibration::Prepare(double fstart, double fstep, int n)
+{
+    stamp++;
+    for (unsigned int g=0; g<grids.size(); g++)
+    {
+        if (grids[g].n==n && grids[g].start==fstart && grids[g].step==fstep)
+        {
+            grids[g].used = stamp;
+            active = g;
+            return;
+        }
+    }
+
+    //Reuse the least recently used slot once the cache is full
+    if (grids.size() < MAX_GRIDS)
+    {
+        grids.push_back(Grid());
+        active = grids.size()-1;
+    }
+    else
+    {
+        active = 0;
+        for (unsigned int g=1; g<grids.size(); g++)
+            if (grids[g].used < grids[active].used)
+                active = g;
+    }
+
+    Grid &grid = grids[active];
+    grid.start = fstart;
+    grid.step = fstep;
+    grid.n = n;
+    grid.used = stamp;
+
+    std::vector<CalTerms> &terms = grid.terms;
+    terms.resize(n);
+    unsigned int j = 0;
+    for (int i=0; i<n; i++)
+    {
+        double f = fstart + i*fstep;
+
+        while (j+2<freqs.size() && freqs[j+1]<f)
+            j++;
+
+        if (freqs.size()==1)
+        {
+            terms[i] = cal_terms[0];
+            continue;
+        }
+
+        double span = freqs[j+1]-freqs[j];
+        double w = span>0 ? (f-freqs[j])/span : 0;
+        if (w<0) w = 0;
+        if (w>1) w = 1;
+
+        const CalTerms &a = cal_terms[j], &b = cal_terms[j+1];
+        terms[i].e00 = a.e00 + w*(b.e00-a.e00);
+        terms[i].e11 = a.e11 + w*(b.e11-a.e11);
+        terms[i].t = a.t + w*(b.t-a.t);
+    }
+}
+
+// Binary file: header, then per frequency the frequency and the raw
+// open, short and load reflections in single precision (32 bytes a point)
+bool Calibration::Save(const QString &filename, QString &error)
+{
+    QFile file(filename);
+
+    if (!IsComplete())
+    {
+        error = "The calibration is not complete";
+        return false;
+    }
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        error = QString("Cannot write file %1: %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    ds << (quint32)CAL_MAGIC << (quint32)CAL_VERSION << name << (quint32)freqs.size();
+    for (unsigned int i=0; i<freqs.size(); i++)
+    {
+        ds << (quint64)freqs[i];
+        for (int s=0; s<3; s++)
+            ds << (float)gamma[s][i].real() << (float)gamma[s][i].imag();
+    }
+    file.close();
+
+    if (ds.status()!=QDataStream::Ok)
+    {
+        error = QString("Cannot write file %1").arg(filename);
+        return false;
+    }
+    return true;
+}
+
+bool Calibration::Load(const QString &filename, QString &error)
+{
+    QFile file(filename);
+    quint32 magic, version, n;
+    QString setname;
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error = QString("Cannot read file %1: %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    ds >> magic >> version;
+    if (magic!=CAL_MAGIC || version!=CAL_VERSION)
+    {
+        error = QString("%1 is not a calibration file").arg(filename);
+        return false;
+    }
+    ds >> setname >> n;
+    if (ds.status()!=QDataStream::Ok)
+    {
+        error = QString("%1 is truncated").arg(filename);
+        return false;
+    }
+    //The count is checked before it sizes anything, a damaged file must not allocate gigabytes
+    if (n>CAL_MAX_POINTS || n>(file.size()-file.pos())/CAL_POINT_BYTES)
+    {
+        error = QString("%1 is damaged, it cannot hold %2 points").arg(filename).arg(n);
+        return false;
+    }
+
+    std::vector<double> f(n);
+    std::vector<cplx> g[3];
+    for (int s=0; s<3; s++)
+        g[s].resize(n);
+    for (unsigned int i=0; i<n && ds.status()==QDataStream::Ok; i++)
+    {
+        quint64 fi;
+        ds >> fi;
+        f[i] = fi;
+        for (int s=0; s<3; s++)
+        {
+            float re, im;
+            ds >> re >> im;
+            g[s][i] = cplx(re, im);
+        }
+    }
+    if (ds.status()!=QDataStream::Ok)
+    {
+        error = QString("%1 is truncated").arg(filename);
+        return false;
+    }
+
+    name = setname;
+    freqs.swap(f);
+    for (int s=0; s<3; s++)
+    {
+        gamma[s].swap(g[s]);
+        measured[s] = true;
+    }
+    grids.clear();
+    active = -1;
+    Solve();
+    return true;
+}
+
+// Reflection against 50 ohms from the raw voltage and current vectors, phases in radians
+cplx Calibration::GammaFromVect(double magv, double phv, double magi, double phi)
+{
+    cplx v = std::polar(magv, phv);
+    cplx i = std::polar(magi, phi);
+    cplx z = std::abs(i)>0 ? v/i : cplx(1e9);
+
+    return (z-50.0)/(z+50.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CalStore::CalStore()
+{
+}
+
+CalStore::~CalStore()
+{
+    for (std::map<QString, Calibration *>::iterator it=loaded.begin(); it!=loaded.end(); ++it)
+        delete it->second;
+}
+
+void CalStore::SetDir(const QString &d)
+{
+    dir = d;
+}
+
+QString CalStore::FileName(const QString &name)
+{
+    return dir + "/" + name + ".cal";
+}
+
+QStringList CalStore::Names()
+{
+    QStringList names;
+    QStringList files = QDir(dir).entryList(QStringList() << "*.cal", QDir::Files, QDir::Name);
+
+    for (int i=0; i<files.size(); i++)
+        names << files[i].left(files[i].size()-4);
+    return names;
+}
+
+// Writes the set under its name and keeps a copy loaded
+bool CalStore::Save(Calibration &cal, QString &error)
+{
+    if (cal.name.isEmpty())
+    {
+        error = "The calibration has no name";
+        return false;
+    }
+    if (!QDir().mkpath(dir))
+    {
+        error = QString("Cannot create %1").arg(dir);
+        return false;
+    }
+    if (!cal.Save(FileName(cal.name), error))
+        return false;
+
+    Calibration *&slot = loaded[cal.name];
+    if (slot)
+        *slot = cal;
+    else
+        slot = new Calibration(cal);
+    return true;
+}
+
+// The set with its interpolation cache, read from disk the first time only
+Calibration *CalStore::Get(const QString &name, QString &error)
+{
+    std::map<QString, Calibration *>::iterator it = loaded.find(name);
+    if (it!=loaded.end())
+        return it->second;
+
+    Calibration *cal = new Calibration();
+    if (!cal->Load(FileName(name), error))
+    {
+        delete cal;
+        return NULL;
+    }
+    loaded[name] = cal;
+    return cal;
+}
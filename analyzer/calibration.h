@@ -0,0 +1,107 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <vector>
+#include <map>
+
+#include <QString>
+#include <QStringList>
+
+#include "cplx.h"
+
+// One-port error model: Gm = e00 + t*Ga/(1-e11*Ga)
+class CalTerms
+{
+public:
+    void fromStandards(cplx open, cplx shrt, cplx load);
+    cplx Correct(cplx gm) const;
+
+    cplx e00, e11, t;       //Directivity, source match, reflection tracking
+};
+
+// Open/short/load calibration measured on the host from raw vectors.
+// Error terms are solved at the calibration frequencies and interpolated
+// onto a sweep grid once; the last few grids are kept so alternating
+// sweep plans do not interpolate again. Correcting a point is a table lookup.
+class Calibration
+{
+public:
+    enum standard_t {open_std, short_std, load_std};
+
+    Calibration();
+    void SetGrid(double fstart, double fend, int n);
+    void SetStandard(standard_t std, const std::vector<cplx> &gamma);
+    bool IsComplete();
+    bool Covers(double fstart, double fend);
+    void Prepare(double fstart, double fstep, int n);
+    cplx Correct(int i, cplx gm) const { return grids[active].terms[i].Correct(gm); }
+
+    bool Save(const QString &filename, QString &error);
+    bool Load(const QString &filename, QString &error);
+
+    static cplx GammaFromVect(double magv, double phv, double magi, double phi);
+
+    static const unsigned int MAX_GRIDS = 8;
+
+    QString name;                   //Fixture or cable the set belongs to
+    std::vector<double> freqs;      //Calibration frequencies, ascending
+    std::vector<cplx> gamma[3];     //Raw reflection of each standard at freqs
+    bool measured[3];
+
+private:
+    struct Grid
+    {
+        double start, step;
+        int n;
+        unsigned long used;             //Stamp of the last Prepare that picked it
+        std::vector<CalTerms> terms;    //Interpolated onto the grid
+    };
+
+    void Solve();
+
+    std::vector<CalTerms> cal_terms;    //At freqs
+    std::vector<Grid> grids;
+    int active;
+    unsigned long stamp;
+};
+
+// Named calibration sets kept as files in one directory. Sets are loaded
+// once and stay in memory with their interpolated grids.
+class CalStore
+{
+public:
+    CalStore();
+    ~CalStore();
+
+    void SetDir(const QString &dir);
+    QStringList Names();
+    bool Save(Calibration &cal, QString &error);
+    Calibration *Get(const QString &name, QString &error);
+
+private:
+    QString FileName(const QString &name);
+
+    QString dir;
+    std::map<QString, Calibration *> loaded;
+};
+
+#endif // CALIBRATION_H
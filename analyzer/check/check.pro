@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Checks of the core library that need no GUI or device
+#
+#-------------------------------------------------
+
+QT       += xml core
+
+TARGET = analyzer-check
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += testcase
+
+SOURCES += main.cpp
+
+include(../core/core.pri)
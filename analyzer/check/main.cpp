@@ -0,0 +1,329 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QThread>
+
+#include "scandata.h"
+#include "calibration.h"
+#include "glitch.h"
+#include "sweepavg.h"
+#include "pointqueue.h"
+#include "sweepplan.h"
+#include "deviceio.h"
+
+static int failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+
+static void check(bool ok, const char *what, const char *file, int line)
+{
+    if (!ok)
+    {
+        printf("FAIL %s:%d: %s\n", file, line, what);
+        failures++;
+    }
+}
+
+static bool near(cplx a, cplx b, double tol = 1e-9)
+{
+    return std::abs(a-b) < tol;
+}
+
+static Sample make_sample(double freq, double R, double X, bool suspect = false)
+{
+    Sample s;
+    s.fromZ(freq, R, X);
+    s.suspect = suspect;
+    return s;
+}
+
+// Error terms solved from the three standards undo the fixture they came from
+static void check_calterms()
+{
+    const cplx e00(0.05,-0.02), e11(0.1,0.07), t(0.9,0.15);
+    const cplx ga[] = {cplx(0.3,0.2), cplx(-0.5,0.1), cplx(0.0,0.0), cplx(0.99,-0.05)};
+    auto measure = [&](cplx g) { return e00 + t*g/(1.0-e11*g); };
+
+    CalTerms terms;
+    terms.fromStandards(measure(1.0), measure(-1.0), measure(0.0));
+    CHECK(near(terms.e00, e00));
+    CHECK(near(terms.e11, e11));
+    CHECK(near(terms.t, t));
+    for (int i=0; i<4; i++)
+        CHECK(near(terms.Correct(measure(ga[i])), ga[i]));
+
+    //Perfect standards leave readings alone
+    terms.fromStandards(1.0, -1.0, 0.0);
+    CHECK(near(terms.Correct(ga[0]), ga[0]));
+}
+
+static void check_glitch()
+{
+    GlitchFilter filter;
+
+    //Too few points to judge anything
+    filter.Add(0.5);
+    filter.Add(0.5);
+    CHECK(!filter.Suspect(0.95));
+
+    //A smooth sweep passes, a jump out of it does not
+    filter.Reset();
+    for (int i=0; i<20; i++)
+    {
+        cplx g = std::polar(0.5+0.002*i, 0.3*i);
+        CHECK(!filter.Suspect(g));
+        filter.Add(g);
+    }
+    CHECK(filter.Suspect(std::polar(0.9, 6.0)));
+    CHECK(!filter.Suspect(std::polar(0.54, 6.0)));
+
+    //Steps smaller than the floor are never flagged, even on a noiseless sweep
+    filter.Reset();
+    for (int i=0; i<10; i++)
+        filter.Add(0.2);
+    CHECK(!filter.Suspect(0.2+0.5*filter.floor));
+    CHECK(filter.Suspect(0.2+2.0*filter.floor));
+}
+
+static void make_sweep(ScanData &scan, double R, int suspect = -1, double glitchR = 500)
+{
+    scan.freq_start = 1000000;
+    scan.freq_end = 2000000;
+    scan.points.clear();
+    for (int i=0; i<4; i++)
+        scan.points.push_back(make_sample(1000000+i*250000, i==suspect ? glitchR : R+i, 0, i==suspect));
+}
+
+static void check_sweepavg()
+{
+    SweepAverager::mode_t modes[] = {SweepAverager::mode_ema, SweepAverager::mode_boxcar};
+
+    for (int m=0; m<2; m++)
+    {
+        SweepAverager avg;
+        ScanData scan;
+        avg.SetMode(modes[m], 4);
+
+        //Identical sweeps average to themselves
+        for (int s=0; s<6; s++)
+        {
+            make_sweep(scan, 60);
+            avg.Add(scan);
+        }
+        CHECK(avg.Count()==6);
+        CHECK(fabs(avg.average.points[2].R-62)<1e-6);
+
+        //A suspect point does not move the average or the holds
+        double max1 = avg.swr_max[1], min1 = avg.swr_min[1];
+        make_sweep(scan, 60, 1);
+        avg.Add(scan);
+        CHECK(fabs(avg.average.points[1].R-61)<1e-6);
+        CHECK(avg.swr_max[1]==max1 && avg.swr_min[1]==min1);
+
+        //Boxcar forgets a level change after a full lap, the EMA converges on it
+        for (int s=0; s<40; s++)
+        {
+            make_sweep(scan, 80);
+            avg.Add(scan);
+        }
+        CHECK(fabs(avg.average.points[0].R-80)<(m==0 ? 1e-3 : 1e-6));
+        CHECK(avg.swr_max[0]>avg.swr_min[0]);
+    }
+
+    //Holds start at the first reading that is not suspect, never at their initial values
+    SweepAverager hold;
+    ScanData scan;
+    make_sweep(scan, 60, 2);
+    hold.Add(scan);
+    CHECK(hold.swr_max[2]==scan.points[2].swr && hold.swr_min[2]==scan.points[2].swr);
+    make_sweep(scan, 60);
+    hold.Add(scan);
+    CHECK(hold.swr_max[2]==scan.points[2].swr && hold.swr_min[2]==scan.points[2].swr);
+    for (unsigned int i=0; i<hold.swr_max.size(); i++)
+        CHECK(hold.swr_min[i]>=1.0 && hold.swr_max[i]<100.0);
+}
+
+// Publishes points whose fields are all derived from their index
+class QueueWriter : public QThread
+{
+public:
+    QueueWriter(PointQueue *q, int n) : queue(q), count(n) {}
+
+    void run()
+    {
+        for (int i=0; i<count; i++)
+            queue->Push(i/1000, i%1000, make_sample(i, 2.0*i+1, -i));
+    }
+
+    PointQueue *queue;
+    int count;
+};
+
+static void check_pointqueue()
+{
+    //A reader more than a ring behind skips to the oldest point still held
+    {
+        PointQueue queue(16);
+        PointQueue::Reader reader(&queue);
+        MeasuredPoint batch[64];
+
+        for (int i=0; i<40; i++)
+            queue.Push(1, i, make_sample(i, 50, 0));
+        int n = reader.Read(batch, 64);
+        CHECK(n==16);
+        CHECK(reader.lost==24);
+        CHECK(batch[0].seq==24 && batch[0].index==24 && batch[n-1].index==39);
+        CHECK(reader.Read(batch, 64)==0);
+
+        queue.Push(2, 0, make_sample(0, 50, 0));
+        reader.Skip();
+        CHECK(reader.Read(batch, 64)==0);
+    }
+
+    //Concurrent readers never see a torn point and account for every one
+    {
+        const int total = 1000000;
+        PointQueue queue(1024);
+        PointQueue::Reader reader(&queue);
+        QueueWriter writer(&queue, total);
+        MeasuredPoint batch[256];
+        uint64_t seen = 0, expect = 0;
+        bool torn = false, ordered = true;
+
+        writer.start();
+        while (!writer.isFinished() || reader.next<queue.Head())
+        {
+            int n = reader.Read(batch, 256);
+            for (int k=0; k<n; k++)
+            {
+                const MeasuredPoint &p = batch[k];
+                uint64_t i = p.seq;
+                if (p.sweep!=i/1000 || p.index!=i%1000 || p.sample.freq!=(double)i ||
+                    p.sample.R!=2.0*i+1 || p.sample.X!=-(double)i)
+                    torn = true;
+                if (i<expect)
+                    ordered = false;
+                expect = i+1;
+            }
+            seen += n;
+        }
+        writer.wait();
+        CHECK(!torn);
+        CHECK(ordered);
+        CHECK(seen+reader.lost==(uint64_t)total);
+        CHECK(reader.next==(uint64_t)total);
+    }
+}
+
+// The SWR bandwidth is the run below swr_bw_max around the minimum, glitches aside
+static void check_bandwidth()
+{
+    ScanData scan;
+    const double R[] = {150, 100, 70, 55, 50, 500, 60, 75, 120, 20};
+    const bool suspect[] = {false, false, false, false, false, true, false, false, false, true};
+
+    scan.swr_bw_max = 1.6;
+    for (int i=0; i<10; i++)
+        scan.points.push_back(make_sample(1000000+i*1000, R[i], 0, suspect[i]));
+    scan.UpdateStats();
+
+    CHECK(scan.swr_min_idx==4);
+    CHECK(scan.swr_bw_lo_idx==2);
+    CHECK(scan.swr_bw_hi_idx==7);
+}
+
+// Counts the events of a sweep
+class EventCounter : public EventReceiver
+{
+public:
+    EventCounter() { events = 0; }
+    void RaiseEvent(event_t, int) { events++; }
+
+    int events;
+};
+
+// Ranges the step cannot walk are refused before the device is touched
+static void check_scan_range()
+{
+    DeviceIO device(false);
+    EventCounter erx;
+    ScanData scan;
+
+    CHECK(!device.Cmd_Scan(scan, 14000000, 14350000, 0, &erx));
+    CHECK(!device.Cmd_Scan(scan, 14000000, 14350000, -10, &erx));
+    CHECK(!device.Cmd_Scan(scan, 14350000, 14000000, 3500, &erx));
+    CHECK(!device.Cmd_Scan(scan, 14000000, 14000100, 1000, &erx));    //Step larger than the span
+    CHECK(erx.events==0);
+    CHECK(scan.points.empty());
+}
+
+static bool plan_ok(const char *xml, QString &error)
+{
+    QDomDocument doc;
+    SweepPlan plan;
+
+    if (!doc.setContent(QString(xml)))
+    {
+        error = "bad XML";
+        return false;
+    }
+    QDomElement root = doc.documentElement();
+    return plan.fromDom(root, error);
+}
+
+static void check_sweepplan()
+{
+    QString error;
+
+    CHECK(plan_ok("<sweepplan><segment start=\"14\" stop=\"14.35\" points=\"100\" repeat=\"2\"/>"
+                  "<segment start=\"7\" stop=\"7.2\" points=\"50\" avg=\"4\" adapt=\"1\"/></sweepplan>", error));
+    CHECK(!plan_ok("<sweepplan><segment start=\"0.5\" stop=\"2\"/></sweepplan>", error));
+    CHECK(!plan_ok("<sweepplan><segment start=\"14\" stop=\"800\"/></sweepplan>", error));
+    CHECK(!plan_ok("<sweepplan><segment start=\"14.35\" stop=\"14\"/></sweepplan>", error));
+    CHECK(!plan_ok("<sweepplan><segment start=\"14\" stop=\"14.35\" points=\"0\"/></sweepplan>", error));
+    CHECK(!plan_ok("<sweepplan><segment start=\"14\" stop=\"14.35\" repeat=\"0\"/></sweepplan>", error));
+
+    //A step below 1 Hz would sweep nothing and divide by zero
+    CHECK(!plan_ok("<sweepplan><segment name=\"dense\" start=\"14\" stop=\"14.0001\" points=\"1000\"/></sweepplan>", error));
+    CHECK(error.contains("dense"));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    check_calterms();
+    check_glitch();
+    check_sweepavg();
+    check_pointqueue();
+    check_bandwidth();
+    check_scan_range();
+    check_sweepplan();
+
+    if (failures)
+        printf("%d checks failed\n", failures);
+    else
+        printf("All checks passed\n");
+    return failures ? 1 : 0;
+}
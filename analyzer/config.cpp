@@ -19,6 +19,7 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QString>
 #include <QSettings>
+#include <QStandardPaths>
 
 #include "config.h"
 
@@ -29,17 +30,22 @@ namespace Config
     *App = "Antenna Analyzer",
     *DOM_ENCODING = "UTF-8";
 
-  QString dir_data;
-  double swr_max, swr_bw_max, Z_Target;
+  QString dir_data, dir_cal;
+  double swr_max, swr_bw_max, Z_Target, adapt_tol;
+  int display_rate;
 
   void read()
   {
     QSettings settings(Org, App);
 
     dir_data = settings.value("dir_data",".").toString();
+    dir_cal = settings.value("dir_cal",
+        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/sark110-analyzer/calibration").toString();
     swr_max = settings.value("swr_max","10").toDouble();
     swr_bw_max = settings.value("swr_bw_max","1.5").toDouble();
     Z_Target = settings.value("Z_Target","50").toDouble();
+    display_rate = settings.value("display_rate","30").toInt();
+    adapt_tol = settings.value("adapt_tol","0.002").toDouble();
   }
 
   void write()
@@ -47,8 +53,11 @@ namespace Config
     QSettings settings(Org, App);
 
     settings.setValue("dir_data", dir_data);
+    settings.setValue("dir_cal", dir_cal);
     settings.setValue("swr_max", swr_max);
     settings.setValue("swr_bw_max", swr_bw_max);
     settings.setValue("Z_Target", Z_Target);
+    settings.setValue("display_rate", display_rate);
+    settings.setValue("adapt_tol", adapt_tol);
   }
 }
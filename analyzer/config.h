@@ -28,8 +28,9 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 namespace Config
 {
-    extern QString dir_data;
-    extern double swr_max, swr_bw_max, Z_Target;
+    extern QString dir_data, dir_cal;
+    extern double swr_max, swr_bw_max, Z_Target, adapt_tol;
+    extern int display_rate;
     extern const char
       *Org,*App,*DOM_ENCODING;
 
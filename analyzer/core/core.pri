@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Links the analyzer core library. Projects drawing with
+# the Graph classes also need QT += gui.
+#
+#-------------------------------------------------
+
+QT += xml core
+
+INCLUDEPATH += $$PWD/.. $$PWD/../sark110
+DEPENDPATH += $$PWD/..
+
+CORE_OUT = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): CORE_OUT = $$CORE_OUT/release
+win32:CONFIG(debug, debug|release): CORE_OUT = $$CORE_OUT/debug
+
+LIBS += -L$$CORE_OUT -lanalyzer-core
+win32-msvc*: PRE_TARGETDEPS += $$CORE_OUT/analyzer-core.lib
+else: PRE_TARGETDEPS += $$CORE_OUT/libanalyzer-core.a
+
+unix {
+LIBS += -ludev
+}
+win32 {
+LIBS += C:\WinDDK\7600.16385.1\lib\wxp\i386\hid.lib
+LIBS += C:\WinDDK\7600.16385.1\lib\wxp\i386\hidparse.lib
+LIBS += C:\WinDDK\7600.16385.1\lib\wxp\i386\hidclass.lib
+LIBS += C:\WinDDK\7600.16385.1\lib\wxp\i386\setupapi.lib
+}
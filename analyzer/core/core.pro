@@ -0,0 +1,57 @@
+#-------------------------------------------------
+#
+# Measurement, data and rendering engines shared by
+# the GUI, the command line tools and the benchmarks.
+# No widgets and no global state in here.
+#
+#-------------------------------------------------
+
+QT       += xml core gui
+QT       -= widgets
+
+TARGET = analyzer-core
+TEMPLATE = lib
+
+CONFIG += staticlib
+
+SOURCES += ../scandata.cpp \
+    ../eventreceiver.cpp \
+    ../deviceio.cpp \
+    ../pointqueue.cpp \
+    ../sweepplan.cpp \
+    ../bands.cpp \
+    ../survey.cpp \
+    ../monitor.cpp \
+    ../tracker.cpp \
+    ../calibration.cpp \
+    ../sweepavg.cpp \
+    ../glitch.cpp \
+    ../graph.cpp \
+    ../sark110/hid.cpp \
+    ../sark110/hid_WINDOWS.cpp \
+    ../sark110/sark_client.cpp
+
+HEADERS  += ../scandata.h \
+    ../eventreceiver.h \
+    ../deviceio.h \
+    ../pointqueue.h \
+    ../sweepplan.h \
+    ../bands.h \
+    ../survey.h \
+    ../monitor.h \
+    ../tracker.h \
+    ../calibration.h \
+    ../sweepavg.h \
+    ../glitch.h \
+    ../cplx.h \
+    ../graph.h \
+    ../dom.h \
+    ../sark110/sark_cmd_defs.h \
+    ../sark110/hidapi.h \
+    ../sark110/hid.h \
+    ../sark110/sark_client.h
+
+INCLUDEPATH += .. ../sark110
+win32 {
+INCLUDEPATH += "C:\Program Files (x86)\Windows Kits\10\Include\10.0.14393.0\shared";"C:\Program Files (x86)\Windows Kits\10\Include\10.0.14393.0\um";"C:\WinDDK\7600.16385.1\inc\ddk";"C:\WinDDK\7600.16385.1\inc\api"
+}
@@ -20,26 +20,52 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
-#include <complex>
 #include <errno.h>
+#include <math.h>
+
+#include <QElapsedTimer>
 
 #include "scandata.h"
 #include "deviceio.h"
 #include "sark_client.h"
 
-extern ScanData scandata;
+DeviceIO::DeviceIO(bool connect)
+{
+    queue = NULL;
+    sweep = 0;
+    samples = 1;
+    event_ms = 1000/30;
+    cal = NULL;
+    thru = false;
+    adapt_max = 0;
+    adapt_tol = 0.002;
+    quiet = 0;
+    readings = points_read = 0;
+    deglitch = false;
+    glitch_retries = 2;
+    glitch_found = glitch_kept = 0;
+    devfd = -1;
 
-DeviceIO::DeviceIO()
+    if (connect)
+        Connect();
+}
+
+// Finds and opens the analyzer, may take a while with many HID devices.
+// Safe to run on a worker thread, IsUp() turns true when it succeeds.
+bool DeviceIO::Connect()
 {
+    QMutexLocker locker(&lock);
+
     int rc = Sark_Connect();
     if (rc < 0)
     {
         devfd = -1;
         printf("Cannot connect to SARK-110\n");
-        return;
+        return false;
     }
     printf("SARK-110 Connected\n");
     devfd = 0;
+    return true;
 }
 
 DeviceIO::~DeviceIO()
@@ -54,42 +80,315 @@ bool DeviceIO::IsUp()
    return (devfd != -1);
 }
 
-void DeviceIO::Cmd_Scan(long fstart, long fend, long fstep, EventReceiver *erx)
+void DeviceIO::SetQueue(PointQueue *q)
+{
+    QMutexLocker locker(&lock);
+    queue = q;
+}
+
+// Id of the last sweep published to the queue, single readings count as sweeps
+unsigned int DeviceIO::Sweep()
+{
+    return sweep;
+}
+
+void DeviceIO::SetSamples(int n)
+{
+    samples = n<1 ? 1 : (n>255 ? 255 : n);
+}
+
+int DeviceIO::Samples()
+{
+    return samples;
+}
+
+void DeviceIO::SetCalibration(Calibration *c)
+{
+    cal = c;
+}
+
+// Adaptive averaging takes up to max readings per point where the reflection
+// is noisy, tol is the standard error of its mean to reach. max <= 1 turns it off
+void DeviceIO::SetAdaptive(int max, double tol)
+{
+    adapt_max = max>255 ? 255 : max;
+    adapt_tol = tol;
+}
+
+void DeviceIO::Adaptive(int &max, double &tol)
+{
+    max = adapt_max;
+    tol = adapt_tol;
+}
+
+// Readings taken per point in the last sweep
+double DeviceIO::ReadingsPerPoint()
+{
+    return points_read ? (double)readings/points_read : 0.0;
+}
+
+// Sweep points whose reflection jumps away from the points before are measured
+// again straight away, up to retries times. A repeat that agrees with the first
+// reading confirms it, one that fits the sweep replaces it, otherwise the point
+// is kept flagged as suspect
+void DeviceIO::SetDeglitch(bool on, int retries)
+{
+    deglitch = on;
+    glitch_retries = retries<0 ? 0 : retries;
+}
+
+void DeviceIO::GlitchCounts(int &found, int &kept)
+{
+    found = glitch_found;
+    kept = glitch_kept;
+}
+
+// Two-port sweeps fill in S21 of every point, SARK-110 MK1 only
+void DeviceIO::SetThru(bool on)
+{
+    thru = on;
+}
+
+bool DeviceIO::Thru()
+{
+    return thru;
+}
+
+void DeviceIO::SetEventRate(int hz)
+{
+    event_ms = hz>0 ? 1000/hz : 0;
+}
+
+// False for a range the step cannot walk, or when the device is lost during the sweep
+bool DeviceIO::Cmd_Scan(ScanData &data, long fstart, long fend, long fstep, EventReceiver *erx)
 {
     Sample sample;
+    QElapsedTimer timer;
 
-    scandata.points.resize(0);
+    data.points.resize(0);
+    data.thru = thru;
+    //Less than one step in the range, progress would divide by zero
+    if (fstep <= 0 || fend <= fstart || (fend-fstart)/fstep < 1)
+        return false;
+    unsigned int id = ++sweep;
+    readings = points_read = 0;
+    quiet = 0;
+    glitch.Reset();
+    glitch_found = glitch_kept = 0;
     int step = 0;
     int nsteps = (fend-fstart)/fstep;
-    for (long freq = fstart; freq < fend; freq+=fstep, step++)
+
+    //Host correction needs the calibration to span the sweep, else the device calibrates
+    bool host = cal && cal->Covers(fstart, fend);
+    if (host)
+        cal->Prepare(fstart, fstep, nsteps+1);
+
+    erx->RaiseEvent(EventReceiver::sweep_started_event, nsteps);
+    timer.start();
+    for (long freq = fstart; freq < fend && step <= nsteps; freq+=fstep, step++)
     {
-        float fR, fX, fS21Re, fS21Im;
-        int rc = Sark_Meas_Rx(freq, true, 1, &fR, &fX, &fS21Re, &fS21Im);
+        cplx gm, s21;
+        bool suspect = false;
+
+        lock.lock();
+        points_read++;
+        int rc = Measure(freq, host, gm, thru ? &s21 : NULL);
+        if (rc >= 0 && deglitch)
+        {
+            suspect = glitch.Suspect(gm);
+            if (suspect)
+                glitch_found++;
+            for (int r=0; r<glitch_retries && suspect; r++)
+            {
+                cplx g2, t2;
+                rc = Measure(freq, host, g2, thru ? &t2 : NULL);
+                if (rc < 0)
+                    break;
+                if (fabs(std::abs(g2)-std::abs(gm)) < glitch.floor)
+                    suspect = false;    //Repeatable, a real feature
+                else if (!glitch.Suspect(g2))
+                {
+                    gm = g2;            //The first reading was the glitch
+                    s21 = t2;
+                    suspect = false;
+                }
+            }
+            if (suspect)
+                glitch_kept++;
+            glitch.Add(gm);
+        }
         if (rc < 0)
         {
             devfd = -1;
             Sark_Close();
+            lock.unlock();
+            erx->RaiseEvent(EventReceiver::error_event, rc);
             break;
         }
-        std::complex<double> cxZ(fR, fX);
-        std::complex<double> cxRho = (cxZ - 50.0) / (cxZ + 50.0);
-        if (std::abs(cxRho) > 0.980197824)
-            sample.swr = 99.999;
-        else
-            sample.swr = (1.0 + std::abs(cxRho)) / (1.0 - std::abs(cxRho));
-        sample.R = fR;
-        sample.X = fX;
-        sample.Z = std::abs(cxZ);
-        sample.freq = freq;
-        scandata.points.push_back(sample);
-        erx->RaiseEvent(EventReceiver::progress_event, 100 * step / nsteps);
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
+        if (host)
+            gm = cal->Correct(step, gm);
+        cplx z = 50.0*(1.0+gm)/(1.0-gm);
+        sample.fromZ(freq, z.real(), z.imag());
+        sample.s21re = s21.real();
+        sample.s21im = s21.imag();
+        sample.suspect = suspect;
+
+        //Pushed under the lock, the monitor thread is the other producer
+        if (queue)
+            queue->Push(id, step, sample);
+        lock.unlock();
+        data.points.push_back(sample);
+
+        //Receivers and the event loop only get the new points at display rate
+        if (timer.elapsed() >= event_ms)
+        {
+            timer.restart();
+            erx->RaiseEvent(EventReceiver::points_event, data.points.size());
+            erx->RaiseEvent(EventReceiver::progress_event, 100 * step / nsteps);
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
+        }
+    }
+    data.UpdateStats();
+    erx->RaiseEvent(EventReceiver::points_event, data.points.size());
+    erx->RaiseEvent(EventReceiver::progress_event, 100);
+    erx->RaiseEvent(EventReceiver::sweep_finished_event, data.points.size());
+    return IsUp();
+}
+
+// Raw reflection at each frequency, for measuring calibration standards
+bool DeviceIO::Cmd_ScanRaw(std::vector<cplx> &gamma, const std::vector<double> &freqs, EventReceiver *erx)
+{
+    QElapsedTimer timer;
+
+    gamma.resize(0);
+    erx->RaiseEvent(EventReceiver::sweep_started_event, freqs.size());
+    timer.start();
+    for (unsigned int i=0; i<freqs.size(); i++)
+    {
+        cplx gm;
+
+        //Standards always get the full sample count, they are measured once
+        lock.lock();
+        int rc = MeasureFixed((long)freqs[i], true, samples, gm, NULL);
+        if (rc < 0)
+        {
+            devfd = -1;
+            Sark_Close();
+        }
+        lock.unlock();
+        if (rc < 0)
+        {
+            erx->RaiseEvent(EventReceiver::error_event, rc);
+            return false;
+        }
+        gamma.push_back(gm);
+
+        if (timer.elapsed() >= event_ms)
+        {
+            timer.restart();
+            erx->RaiseEvent(EventReceiver::progress_event, 100 * i / freqs.size());
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
+        }
+    }
+    erx->RaiseEvent(EventReceiver::progress_event, 100);
+    erx->RaiseEvent(EventReceiver::sweep_finished_event, gamma.size());
+    return true;
+}
+
+// Reflection at a point, averaged over the sample count or adaptively,
+// called with the lock held
+int DeviceIO::Measure(long freq, bool raw, cplx &gm, cplx *s21)
+{
+    if (adapt_max <= 1)
+    {
+        readings += samples;
+        return MeasureFixed(freq, raw, samples, gm, s21);
     }
-    scandata.UpdateStats();
+
+    //Points following quiet ones take one reading, every PROBE_POINTS-th point
+    //and those following a noisy one take readings until the standard error of
+    //the mean reflection is below adapt_tol, or adapt_max readings
+    int want = (quiet>0 && quiet%PROBE_POINTS) ? 1 : adapt_max;
+    double m2 = 0;      //Sum of squared deviations from the running mean
+    cplx s21sum = 0;
+    int n = 0;
+    bool settled = false;
+
+    gm = 0;
+    while (n < want)
+    {
+        cplx g, t;
+        int rc = MeasureFixed(freq, raw, 1, g, s21 ? &t : NULL);
+        if (rc < 0)
+            return rc;
+        n++;
+        cplx d = g - gm;
+        gm += d/(double)n;
+        m2 += std::real(d*std::conj(g-gm));
+        s21sum += t;
+        settled = n>=2 && m2/((n-1)*n) < adapt_tol*adapt_tol;
+        if (settled)
+            break;
+    }
+    if (s21)
+        *s21 = s21sum/(double)n;
+    readings += n;
+
+    if (want==1)
+        quiet++;
+    else
+        quiet = settled && n==2 ? 1 : 0;
+    return 1;
+}
+
+// Reflection averaged over n readings, from the raw vectors or the device
+// calibrated impedance. Transmission too when s21 is given. Called with the lock held
+int DeviceIO::MeasureFixed(long freq, bool raw, int n, cplx &gm, cplx *s21)
+{
+    if (!raw)
+    {
+        float fR, fX, fS21Re, fS21Im;
+        int rc = Sark_Meas_Rx(freq, true, n, &fR, &fX, &fS21Re, &fS21Im);
+        if (rc < 0)
+            return rc;
+        cplx z(fR, fX);
+        gm = (z-50.0)/(z+50.0);
+        if (s21)
+            *s21 = cplx(fS21Re, fS21Im);
+        return rc;
+    }
+
+    gm = 0;
+    if (s21)
+        *s21 = 0;
+    for (int i=0; i<n; i++)
+    {
+        float fMagV, fPhV, fMagI, fPhI;
+        int rc = Sark_Meas_Vect(freq, &fMagV, &fPhV, &fMagI, &fPhI);
+        if (rc < 0)
+            return rc;
+        gm += Calibration::GammaFromVect(fMagV, fPhV, fMagI, fPhI);
+
+        //Uncorrected transmission, output over input voltage
+        if (s21)
+        {
+            float fMagVout, fPhVout, fMagVin, fPhVin;
+            rc = Sark_Meas_Vect_Thru(freq, &fMagVout, &fPhVout, &fMagVin, &fPhVin);
+            if (rc < 0)
+                return rc;
+            if (fMagVin > 0)
+                *s21 += std::polar((double)fMagVout/fMagVin, (double)fPhVout-fPhVin);
+        }
+    }
+    gm /= (double)n;
+    if (s21)
+        *s21 /= (double)n;
+    return 1;
 }
 
 void DeviceIO::Cmd_Off()
 {
+    QMutexLocker locker(&lock);
     float fR, fX, fS21Re, fS21Im;
     int rc = Sark_Meas_Rx(0, true, 1, &fR, &fX, &fS21Re, &fS21Im);
     if (rc < 0)
@@ -99,24 +398,22 @@ void DeviceIO::Cmd_Off()
     }
 }
 
-void DeviceIO::Cmd_Single(long freq, Sample &sample)
+// Device error code, < 0, when no reading was taken and sample is unchanged
+int DeviceIO::Cmd_Single(long freq, Sample &sample)
 {
+    QMutexLocker locker(&lock);
     float fR, fX, fS21Re, fS21Im;
-    int rc = Sark_Meas_Rx(freq, true, 1, &fR, &fX, &fS21Re, &fS21Im);
+    if (devfd < 0)
+        return -1;
+    int rc = Sark_Meas_Rx(freq, true, samples, &fR, &fX, &fS21Re, &fS21Im);
     if (rc < 0)
     {
         devfd = -1;
         Sark_Close();
+        return rc;
     }
-    std::complex<double> cxZ(fR, fX);
-    std::complex<double> cxRho = (cxZ - 50.0) / (cxZ + 50.0);
-    if (std::abs(cxRho) > 0.980197824)
-        sample.swr = 99.999;
-    else
-        sample.swr = (1.0 + std::abs(cxRho)) / (1.0 - std::abs(cxRho));
-    sample.R = fR;
-    sample.X = fX;
-    sample.Z = std::abs(cxZ);
-    sample.freq = freq;
-    scandata.points.push_back(sample);
+    sample.fromZ(freq, fR, fX);
+    if (queue)
+        queue->Push(++sweep, 0, sample);
+    return 0;
 }
@@ -20,8 +20,14 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef DEVICEIO_H
 #define DEVICEIO_H
 
+#include <atomic>
+
 #include <QString>
+#include <QMutex>
 #include "scandata.h"
+#include "pointqueue.h"
+#include "calibration.h"
+#include "glitch.h"
 
 #define FMIN 1000000
 #define FMAX 700000000
@@ -29,18 +35,52 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 class DeviceIO
 {
 public:
-    DeviceIO();
+    DeviceIO(bool connect = true);
     ~DeviceIO();
 
+    bool Connect();
     bool IsUp();
-    void Cmd_Scan(long fstart, long fend, long fstep, EventReceiver *erx);
-    void Cmd_Single(long freq, Sample &sample);
+    bool Cmd_Scan(ScanData &data, long fstart, long fend, long fstep, EventReceiver *erx);
+    int Cmd_Single(long freq, Sample &sample);
+    bool Cmd_ScanRaw(std::vector<cplx> &gamma, const std::vector<double> &freqs, EventReceiver *erx);
     void Cmd_Off();
+    void SetQueue(PointQueue *q);
+    unsigned int Sweep();
+    void SetSamples(int n);
+    int Samples();
+    void SetEventRate(int hz);
+    void SetCalibration(Calibration *c);
+    void SetThru(bool on);
+    bool Thru();
+    void SetAdaptive(int max, double tol = 0.002);
+    void Adaptive(int &max, double &tol);
+    double ReadingsPerPoint();
+    void SetDeglitch(bool on, int retries = 2);
+    void GlitchCounts(int &found, int &kept);
 
 protected:
-    int devfd;
+    std::atomic<int> devfd;
+    PointQueue *queue;      //Optional, receives every measured point
+    int samples;            //Readings averaged by the device per point
+    int event_ms;           //Minimum time between point batches, 0 for every point
+    std::atomic<unsigned int> sweep;    //Id of the last sweep published to the queue
+    QMutex lock;            //Serialises device access between threads
+    Calibration *cal;       //Host side correction, NULL to use the device calibration
+    bool thru;              //Also measure S21, port 2 connected
+    int adapt_max;          //Most readings per point in adaptive averaging, <= 1 when off
+    double adapt_tol;       //Standard error of the mean reflection adaptive averaging aims for
+    int quiet;              //Consecutive points that needed no extra readings
+    unsigned long readings, points_read;    //Counted over the last sweep
+    bool deglitch;          //Test every sweep point as it arrives
+    int glitch_retries;     //Readings again at a suspect point, 0 to only flag it
+    int glitch_found, glitch_kept;  //Suspect points in the last sweep, and those left flagged
+    GlitchFilter glitch;
 
 private:
+    int Measure(long freq, bool raw, cplx &gm, cplx *s21);
+    int MeasureFixed(long freq, bool raw, int n, cplx &gm, cplx *s21);
+
+    static const int PROBE_POINTS = 8;  //Quiet stretches are still checked this often
 };
 
 #endif // DEVICEIO_H
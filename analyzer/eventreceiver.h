@@ -23,7 +23,12 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 class EventReceiver
 {
 public:
-    enum event_t {progress_event};
+    // progress_event:       arg = percentage done
+    // points_event:         arg = points now in the scan, those past the last batch are new
+    // sweep_started_event:  arg = steps planned
+    // sweep_finished_event: arg = points measured
+    // error_event:          arg = device error code
+    enum event_t {progress_event, points_event, sweep_started_event, sweep_finished_event, error_event};
     //union eventarg_t {double d; int i;};
 
     //EventReceiver();
@@ -0,0 +1,86 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "glitch.h"
+
+GlitchFilter::GlitchFilter(int w, double t)
+{
+    window = w<3 ? 3 : w;
+    threshold = t;
+    floor = 0.03;
+    Reset();
+}
+
+// Forgets the points, call at the start of every sweep
+void GlitchFilter::Reset()
+{
+    ring.assign(window, 0.0);
+    sorted.resize(window);
+    dev.resize(window);
+    pos = count = 0;
+    dirty = true;
+}
+
+void GlitchFilter::Add(cplx g)
+{
+    ring[pos] = std::abs(g);
+    pos = (pos+1) % window;
+    if (count < window)
+        count++;
+    dirty = true;
+}
+
+// Median and MAD of the window, only recomputed after a point is added
+void GlitchFilter::Update()
+{
+    int mid = count/2;
+
+    std::copy(ring.begin(), ring.begin()+count, sorted.begin());
+    std::nth_element(sorted.begin(), sorted.begin()+mid, sorted.begin()+count);
+    median = sorted[mid];
+
+    for (int i=0; i<count; i++)
+        dev[i] = fabs(ring[i]-median);
+    std::nth_element(dev.begin(), dev.begin()+mid, dev.begin()+count);
+    mad = 1.4826*dev[mid];  //Scaled to a standard deviation for normal noise
+    dirty = false;
+}
+
+// How far a reflection is from the window median, in units of the allowed deviation
+double GlitchFilter::Distance(cplx g)
+{
+    if (count < 3)
+        return 0.0;
+    if (dirty)
+        Update();
+
+    double limit = threshold*mad;
+    if (limit < floor)
+        limit = floor;
+    return fabs(std::abs(g)-median)/limit;
+}
+
+bool GlitchFilter::Suspect(cplx g)
+{
+    return Distance(g) > 1.0;
+}
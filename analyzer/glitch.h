@@ -0,0 +1,55 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GLITCH_H
+#define GLITCH_H
+
+#include <vector>
+
+#include "cplx.h"
+
+// Streaming Hampel test for sweeps: a reading is suspect when its reflection
+// magnitude lies further from the median of the last few points than threshold
+// times their median absolute deviation. The magnitude stays smooth where the
+// phase turns quickly, e.g. behind a feeder. A steep resonance can still be
+// flagged, so a suspect reading is worth measuring again before it is believed.
+class GlitchFilter
+{
+public:
+    GlitchFilter(int window = 5, double threshold = 4.0);
+    void Reset();
+    bool Suspect(cplx g);
+    void Add(cplx g);
+    double Distance(cplx g);
+
+    int window;         //Points the median is taken over
+    double threshold;   //In estimated standard deviations
+    double floor;       //Smallest deviation ever flagged, against quantised readings
+
+private:
+    void Update();
+
+    std::vector<double> ring;           //Magnitudes of the last points
+    std::vector<double> sorted, dev;    //Scratch for the medians
+    int pos, count;
+    bool dirty;
+    double median, mad;
+};
+
+#endif // GLITCH_H
@@ -47,6 +47,50 @@ void Graph::Draw(QPainter &painter)
             items[i]->Draw(painter);
 }
 
+void Graph::DrawStatic(QPainter &painter)
+{
+    for (unsigned int i=0;i<items.size();i++)
+        if (items[i]->enabled && items[i]->IsStatic())
+            items[i]->Draw(painter);
+}
+
+void Graph::DrawDynamic(QPainter &painter)
+{
+    for (unsigned int i=0;i<items.size();i++)
+        if (items[i]->enabled && !items[i]->IsStatic())
+            items[i]->Draw(painter);
+}
+
+bool Graph::StaticChanged()
+{
+    for (unsigned int i=0;i<items.size();i++)
+        if (items[i]->IsStatic() && items[i]->Changed())
+            return true;
+    return false;
+}
+
+// Paints rect of a canvas widget. The static items are kept in layer, which is
+// only redrawn when the size or one of them changes
+void Graph::Paint(QPainter &painter, QPixmap &layer, const QRect &rect)
+{
+    SetSize(painter.viewport());
+
+    if (layer.size()!=painter.viewport().size() || StaticChanged())
+    {
+        layer = QPixmap(painter.viewport().size());
+        layer.fill(Qt::white);
+
+        QPainter lp(&layer);
+        DrawStatic(lp);
+        lp.end();
+    }
+
+    painter.drawPixmap(rect,layer,rect);
+
+    painter.setClipRect(rect);
+    DrawDynamic(painter);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 GraphItem::GraphItem(Graph *g)
@@ -75,12 +119,31 @@ GraphScale::GraphScale(Graph *g, pos_t p) : GraphItem(g)
     labsuffix = "";
     title = "";
     labdiv = 1.0;
+    drawn_vmin = drawn_vmax = drawn_vinc = 0;
+    drawn_xo = drawn_yo = drawn_w = drawn_h = -1;
+}
+
+bool GraphScale::Changed()
+{
+    return drawn_vmin!=vmin || drawn_vmax!=vmax || drawn_vinc!=vinc ||
+           drawn_xo!=graph->xo || drawn_yo!=graph->yo || drawn_w!=graph->w || drawn_h!=graph->h ||
+           drawn_title!=title;
 }
 
 void GraphScale::Draw(QPainter &painter)
 {
     double scale;
-    int x,y,w,w_max,font_h = QFontMetrics(font).height();
+    QFontMetrics fm(font);
+    int x,y,w,w_max,font_h = fm.height();
+
+    drawn_vmin = vmin;
+    drawn_vmax = vmax;
+    drawn_vinc = vinc;
+    drawn_xo = graph->xo;
+    drawn_yo = graph->yo;
+    drawn_w = graph->w;
+    drawn_h = graph->h;
+    drawn_title = title;
 
     painter.setPen(pen);
     painter.setFont(font);
@@ -97,7 +160,7 @@ void GraphScale::Draw(QPainter &painter)
             x=graph->xo + (v-vmin)*scale;
         //printf("x=%d\n",x);
             painter.drawLine(x,graph->yo,x,graph->yo + 10);
-            x=x - QFontMetrics(font).boundingRect(s).width()/2;
+            x=x - fm.boundingRect(s).width()/2;
             painter.drawText(x,graph->yo + 10 + font_h,s);
         }
         break;
@@ -111,7 +174,7 @@ void GraphScale::Draw(QPainter &painter)
             QString s = (labdps<0 ? QString("%1").arg(v/labdiv) : QString("%1").arg(v/labdiv, 0, 'f', labdps)) + labsuffix;
             y=graph->yo - (v-vmin)*scale;
             painter.drawLine(graph->xo,y,graph->xo-10,y);
-            w = QFontMetrics(font).boundingRect(s).width();
+            w = fm.boundingRect(s).width();
             x=graph->xo - 12 - w;
             painter.drawText(x,y + font_h/2.5,s);
             if (w>w_max) w_max=w;
@@ -120,7 +183,7 @@ void GraphScale::Draw(QPainter &painter)
         {
             x=graph->xo;
             y=graph->yo - graph->h/2.0;
-            w=QFontMetrics(font).boundingRect(title).width();
+            w=fm.boundingRect(title).width();
             painter.save();
             painter.translate(x,y);
             painter.rotate(-90.0);
@@ -139,7 +202,7 @@ void GraphScale::Draw(QPainter &painter)
             QString s = (labdps<0 ? QString("%1").arg(v/labdiv) : QString("%1").arg(v/labdiv, 0, 'f', labdps)) + labsuffix;
             x=graph->xo + graph->w;
             y=graph->yo - (v-vmin)*scale;
-            w = QFontMetrics(font).boundingRect(s).width();
+            w = fm.boundingRect(s).width();
             painter.drawLine(x,y,x+10,y);
             painter.drawText(x+12,y + font_h/2.5,s);
             if (w>w_max) w_max=w;
@@ -148,7 +211,7 @@ void GraphScale::Draw(QPainter &painter)
         {
             x=graph->xo + graph->w;
             y=graph->yo - graph->h/2.0;
-            w=QFontMetrics(font).boundingRect(title).width();
+            w=fm.boundingRect(title).width();
             painter.save();
             painter.translate(x,y);
             painter.rotate(90.0);
@@ -184,6 +247,26 @@ void GraphScale::Expand(double min,double max)
     if (max>vmax) vmax=max;
 }
 
+// Grows the scale to a round value enclosing v, returns true if the scale changed
+bool GraphScale::Fit(double v)
+{
+    if (v>vmax)
+    {
+        vmax=v;
+        SetIncAuto();
+        vmax=ceil(vmax/vinc)*vinc;
+        return true;
+    }
+    if (v<vmin)
+    {
+        vmin=v;
+        SetIncAuto();
+        SetMinAuto();
+        return true;
+    }
+    return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //GraphHorizLine::GraphHorizLine(Graph *g, GraphScale *s) : GraphItem(g)
@@ -220,20 +303,149 @@ void GraphVertLine::Draw(QPainter &painter)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+TraceDecimator::TraceDecimator()
+{
+    Reset();
+}
+
+void TraceDecimator::Reset()
+{
+    cols.clear();
+    idx.clear();
+    done = span = 0;
+    closed = idxclosed = 0;
+    ncols = 0;
+}
+
+void TraceDecimator::Update(const std::vector<double> &points, unsigned int n, int columns)
+{
+    if (columns!=ncols || n!=span || points.size()<done)
+    {
+        Reset();
+        ncols = columns;
+        span = n;
+    }
+    if (done==points.size())
+        return;
+
+    //Only the points not seen yet are aggregated, the last column may be still open
+    for (unsigned int i=done;i<points.size();i++)
+    {
+        unsigned int c = (unsigned long long)i*ncols/span;
+        if (c>=cols.size())
+        {
+            Column col = {i,i,i,i};
+            cols.push_back(col);
+            continue;
+        }
+        Column &col = cols.back();
+        col.last = i;
+        if (points[i]<points[col.min]) col.min = i;
+        if (points[i]>points[col.max]) col.max = i;
+    }
+    done = points.size();
+
+    //Indices of closed columns are kept, only those from the open column on are redone
+    idx.resize(idxclosed);
+    for (unsigned int c=closed;c<cols.size();c++)
+    {
+        unsigned int v[4] = {cols[c].first, cols[c].min, cols[c].max, cols[c].last};
+        if (v[1]>v[2]) { v[1] = cols[c].max; v[2] = cols[c].min; }
+        if (c+1==cols.size())
+        {
+            closed = c;
+            idxclosed = idx.size();
+        }
+        for (int k=0;k<4;k++)
+            if (idx.empty() || v[k]!=idx.back())
+                idx.push_back(v[k]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 //GraphTrace::GraphTrace(Graph *g, GraphScale *s) : GraphItem(g)
 //{
 //    scale = s;
 //}
 
-void GraphTrace::Draw(QPainter &painter)
+void GraphTrace::Invalidate()
 {
-    painter.setPen(pen);
-    for (unsigned int i=1;i<points.size();i++)
+    dirty = true;
+}
+
+unsigned int GraphTrace::Span()
+{
+    return points.size()>span ? points.size() : span;
+}
+
+void GraphTrace::Update()
+{
+    unsigned int n = Span();
+    bool timed = xscale && xpoints.size()==points.size();
+    bool moved = xo!=graph->xo || yo!=graph->yo || w!=graph->w || h!=graph->h ||
+                 vmin!=scale->vmin || vmax!=scale->vmax || n!=xcount ||
+                 (timed && (xmin!=xscale->vmin || xmax!=xscale->vmax));
+
+    if (!dirty && !moved && count==points.size())
+        return;
+
+    if (dirty || w!=graph->w)
+        decimator.Reset();
+
+    //Points appended to an unchanged trace only need their own coordinates
+    bool append = !dirty && !moved && count<points.size();
+
+    xo = graph->xo;
+    yo = graph->yo;
+    w = graph->w;
+    h = graph->h;
+    vmin = scale->vmin;
+    vmax = scale->vmax;
+    xmin = timed ? xscale->vmin : 0.0;
+    xmax = timed ? xscale->vmax : 0.0;
+    xcount = n;
+    dirty = false;
+
+    double xs = n>1 ? (double)w/(n-1) : 0.0;
+    double ys = h/(vmax-vmin);
+
+    if (timed)
+    {
+        //Placed by their own x values, the decimator assumes even spacing
+        double xts = xmax>xmin ? w/(xmax-xmin) : 0.0;
+        poly.resize(points.size());
+        for (unsigned int i=append ? count : 0;i<points.size();i++)
+            poly[i] = QPointF(xo + (xpoints[i]-xmin)*xts, yo - (points[i]-vmin)*ys);
+    }
+    else if (w>0 && n>(unsigned int)(4*w))
     {
-        //printf("i=%d\n",i);
-        painter.drawLine(graph->xo + (i-1)*graph->w/(points.size()-1),graph->yo - (points[i-1]-scale->vmin)/(scale->vmax-scale->vmin)*graph->h,
-                graph->xo + i*graph->w/(points.size()-1),graph->yo - (points[i]-scale->vmin)/(scale->vmax-scale->vmin)*graph->h);
+        //More points than pixels: plot only the per-column envelope
+        unsigned int from = append ? decimator.Stable() : 0;
+        decimator.Update(points,n,w);
+        poly.resize(decimator.idx.size());
+        for (unsigned int k=from;k<decimator.idx.size();k++)
+        {
+            unsigned int i = decimator.idx[k];
+            poly[k] = QPointF(xo + i*xs, yo - (points[i]-vmin)*ys);
+        }
     }
+    else
+    {
+        poly.resize(points.size());
+        for (unsigned int i=append ? count : 0;i<points.size();i++)
+            poly[i] = QPointF(xo + i*xs, yo - (points[i]-vmin)*ys);
+    }
+    count = points.size();
+}
+
+void GraphTrace::Draw(QPainter &painter)
+{
+    if (points.size()<2)
+        return;
+    Update();
+    painter.setPen(pen);
+    painter.drawPolyline(poly);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
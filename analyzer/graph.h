@@ -23,6 +23,8 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPainter>
 #include <QRect>
 #include <QFont>
+#include <QPolygonF>
+#include <QPixmap>
 
 class GraphItem;
 
@@ -33,6 +35,10 @@ public:
     void SetSize(QRect size);
     void AddItem(GraphItem *item);
     void Draw(QPainter &painter);
+    void DrawStatic(QPainter &painter);
+    void DrawDynamic(QPainter &painter);
+    bool StaticChanged();
+    void Paint(QPainter &painter, QPixmap &layer, const QRect &rect);
 
     int marginl,marginb,marginr,margint;
     int xo,yo,w,h;
@@ -47,6 +53,8 @@ public:
     GraphItem(Graph *g);
     virtual ~GraphItem() {};
     virtual void Draw(QPainter &painter) = 0;
+    virtual bool IsStatic() { return false; }
+    virtual bool Changed() { return false; }
 
     bool enabled;
     QPen pen;
@@ -63,9 +71,12 @@ public:
     GraphScale(Graph *g, pos_t p);
     virtual ~GraphScale() {};
     void Draw(QPainter &painter);
+    bool IsStatic() { return true; }
+    bool Changed();
     void SetIncAuto();
     void SetMinAuto();
     void Expand(double min,double max);
+    bool Fit(double v);
 
     QFont font;
     double vmin, vmax, vinc;
@@ -73,6 +84,12 @@ public:
     int labdps;
     QString title,labsuffix;
     double labdiv;
+
+private:
+    //State the scale was last drawn with, to know when a cached drawing is stale
+    double drawn_vmin, drawn_vmax, drawn_vinc;
+    int drawn_xo, drawn_yo, drawn_w, drawn_h;
+    QString drawn_title;
 };
 
 class GraphDataItem : public GraphItem
@@ -110,17 +127,54 @@ public:
 //    GraphScale *scale;
 };
 
+// Reduces a trace to what a pixel column can show. While the span n and the
+// number of columns stay the same, Update only looks at the points appended
+// since the last call and at the column still open, so a sweep plotted point
+// by point costs O(new points) per update. A new n or width starts over.
+class TraceDecimator
+{
+public:
+    TraceDecimator();
+    void Reset();
+    void Update(const std::vector<double> &points, unsigned int n, int columns);
+    unsigned int Stable() { return idxclosed; }   //Leading indices the next Update keeps
+
+    //Indices of the points to plot: first, min, max and last of every pixel column
+    std::vector<unsigned int> idx;
+
+private:
+    struct Column { unsigned int first, last, min, max; };
+
+    std::vector<Column> cols;
+    unsigned int done, span;
+    unsigned int closed, idxclosed;     //Columns no later point can change, and their indices
+    int ncols;
+};
+
 class GraphTrace : public GraphDataItem
 {
 public:
-    GraphTrace(Graph *g, GraphScale *s) : GraphDataItem(g,s) {};
+    GraphTrace(Graph *g, GraphScale *s) : GraphDataItem(g,s) { dirty = true; span = count = xcount = 0; xscale = NULL; };
     virtual ~GraphTrace() {};
     void Draw(QPainter &painter);
+    void Invalidate();
+    unsigned int Span();
 
     std::vector<double> points;
+    unsigned int span;  //Number of x positions the trace will fill, 0 to fit the points present
+    std::vector<double> xpoints;    //Positions of the points on xscale, empty to spread them evenly
+    GraphScale *xscale;
 
-//private:
-//    GraphScale *scale;
+private:
+    void Update();
+
+    //Device coordinates of points, rebuilt only when data, scale or size change
+    QPolygonF poly;
+    TraceDecimator decimator;
+    bool dirty;
+    unsigned int count, xcount;
+    int xo,yo,w,h;
+    double vmin,vmax,xmin,xmax;
 };
 
 #endif // GRAPH_H
@@ -23,12 +23,8 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "config.h"
 
-#include "scandata.h"
-
 #include "graphcanvas.h"
 
-extern ScanData scandata;
-
 GraphCanvas::GraphCanvas(QWidget *parent) :
     QFrame(parent)
 {
@@ -93,6 +89,24 @@ GraphCanvas::GraphCanvas(QWidget *parent) :
     rtrace->pen = pen5;  //TODO: tidy
     graph.AddItem(rtrace);
 
+    //|S21| in dB, shares the right scale with Z,R,X so only one of them is shown
+    s21trace = new GraphTrace(&graph,yscale2);
+    s21trace->pen = QPen(Qt::magenta,0);
+    s21trace->enabled = false;
+    graph.AddItem(s21trace);
+
+    swravgtrace = new GraphTrace(&graph,yscale1);
+    swravgtrace->pen = QPen(Qt::darkBlue,0,Qt::DashLine);
+    graph.AddItem(swravgtrace);
+
+    swrmaxtrace = new GraphTrace(&graph,yscale1);
+    swrmaxtrace->pen = QPen(QColor(150,150,255),0);
+    graph.AddItem(swrmaxtrace);
+
+    swrmintrace = new GraphTrace(&graph,yscale1);
+    swrmintrace->pen = QPen(QColor(150,150,255),0);
+    graph.AddItem(swrmintrace);
+
     ZZeroLine = new GraphHorizLine(&graph,yscale2);
     ZZeroLine->pen = QPen(Qt::black,0);
     graph.AddItem(ZZeroLine);
@@ -115,28 +129,28 @@ GraphCanvas::~GraphCanvas()
     delete ztrace;
 }
 
-void GraphCanvas::paintEvent(QPaintEvent *)
+void GraphCanvas::paintEvent(QPaintEvent *ev)
 {
     QPainter painter(this);
 
-//cursor->move(0,0);
-//cursor->resize(1,height());
-
-    ////////////////////
-
-    painter.setBackgroundMode(Qt::OpaqueMode); //??
-    painter.setBackground(Qt::white);
-    painter.eraseRect(painter.viewport());
-
-    painter.setBackgroundMode(Qt::TransparentMode); //??
-
-    graph.SetSize(painter.viewport());
+    graph.Paint(painter,layer,ev->rect());
+    painter.end();
+}
 
-    graph.Draw(painter);
+// Repaints only the strip of the canvas holding points first to last
+void GraphCanvas::UpdatePoints(unsigned int first, unsigned int last)
+{
+    unsigned int n = swrtrace->Span();
 
-    ////////////////////
+    if (n<2 || graph.w<=0)
+    {
+        update();
+        return;
+    }
 
-    painter.end();
+    int x1 = graph.xo + (double)first*graph.w/(n-1) - 2;
+    int x2 = graph.xo + (double)last*graph.w/(n-1) + 2;
+    update(QRect(x1,0,x2-x1+1,height()));
 }
 
 void GraphCanvas::mouseMoveEvent(QMouseEvent *ev)
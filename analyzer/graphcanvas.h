@@ -22,6 +22,7 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QFrame>
 #include <QMouseEvent>
+#include <QPixmap>
 
 #include "graph.h"
 #include "graphcursor.h"
@@ -37,18 +38,23 @@ public:
 
     Graph graph;
     GraphScale *xscale,*yscale1, *yscale2;
-    GraphTrace *swrtrace, *ztrace, *xtrace, *rtrace;
+    GraphTrace *swrtrace, *ztrace, *xtrace, *rtrace, *s21trace;
+    GraphTrace *swravgtrace, *swrmaxtrace, *swrmintrace;    //Aggregates over continuous sweeps
     GraphVertLine *swrminline;
     GraphHorizLine *ZZeroLine, *ZTargetline,*SWRTargetline;
 
+    void UpdatePoints(unsigned int first, unsigned int last);
+
 signals:
     void cursorMoved(double pos);
 
 public slots:
 
 private:
-    void paintEvent(QPaintEvent *);
+    void paintEvent(QPaintEvent *ev);
     void mouseMoveEvent(QMouseEvent *ev);
+
+    QPixmap layer;  //Background, axes and labels; redrawn only when the scales or size change
 };
 
 #endif // GRAPHCANVAS_H
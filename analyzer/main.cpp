@@ -18,12 +18,41 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "mainwindow.h"
+#include "sweepserver.h"
 #include <QApplication>
 
 #include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+// --daemon[=name]: no GUI, serve the analyzer on a local socket
+static int daemon_main(int argc, char *argv[], const char *name)
+{
+    QCoreApplication a(argc, argv);
+
+    Config::read();
+
+    SweepServer server;
+    if (!server.Listen(name))
+    {
+        fprintf(stderr, "Cannot listen on %s (another daemon running?)\n", name);
+        return 1;
+    }
+    printf("Listening on %s\n", server.ServerName().toLocal8Bit().data());
+
+    return a.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    for (int i=1; i<argc; i++)
+    {
+        if (!strcmp(argv[i], "--daemon"))
+            return daemon_main(argc, argv, "analyzer");
+        if (!strncmp(argv[i], "--daemon=", 9))
+            return daemon_main(argc, argv, argv[i]+9);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
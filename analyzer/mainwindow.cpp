@@ -19,15 +19,29 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdio.h>
 #include <locale.h>
+#include <math.h>
+
+#include <algorithm>
 
 #include <QDir>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QClipboard>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
 
 #include "scandata.h"
 
 #include "settingsdlg.h"
+#include "sweepplan.h"
+#include "survey.h"
+#include "bands.h"
+#include "tracker.h"
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
@@ -35,11 +49,10 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 const Version
     MainWindow::version = Version(1,10,13,"");
 
-ScanData scandata;
-
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    plotreader(&pointqueue)
 {
     setlinebuf(stdout);
 
@@ -53,6 +66,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect(ui->actionLoad, SIGNAL(triggered()), this, SLOT(Slot_Load()));
     connect(ui->actionSave, SIGNAL(triggered()), this, SLOT(Slot_Save()));
+    connect(ui->actionRunPlan, SIGNAL(triggered()), this, SLOT(Slot_RunPlan()));
     connect(ui->actionSettings, SIGNAL(triggered()), this, SLOT(Slot_Settings()));
     connect(ui->actionQuit, SIGNAL(triggered()), qApp, SLOT(quit()));
     connect(ui->actionAbout_QT, SIGNAL(triggered()), qApp, SLOT(aboutQt()));
@@ -60,12 +74,21 @@ MainWindow::MainWindow(QWidget *parent) :
 
 //    connect(ui->menuDevice, SIGNAL(aboutToShow()), this, SLOT(Slot_menuDevice_Show()));
 //    connect(ui->menuDevice, SIGNAL(triggered(QAction *)), this, SLOT(Slot_menuDevice_Select(QAction *)));
-    connect(ui->menuDevice, SIGNAL(triggered()), this, SLOT(Slot_menuDevice_Select()));
+    connect(ui->actionDevices, SIGNAL(triggered()), this, SLOT(Slot_menuDevice_Select()));
+    connect(ui->actionCalibrate, SIGNAL(triggered()), this, SLOT(Slot_Calibrate()));
+    connect(ui->actionHostCal, SIGNAL(toggled(bool)), this, SLOT(Slot_HostCal_toggled(bool)));
+    connect(ui->actionSaveCal, SIGNAL(triggered()), this, SLOT(Slot_SaveCal()));
+    connect(ui->actionLoadCal, SIGNAL(triggered()), this, SLOT(Slot_LoadCal()));
+    calstore.SetDir(Config::dir_cal);
+    hostcal = NULL;
 
     connect(ui->canvas1, SIGNAL(cursorMoved(double)), this, SLOT(Slot_cursor_move(double)));
 
     connect(ui->scanBtn,SIGNAL(clicked()),this,SLOT(Slot_ScanSingle_click()));
     connect(ui->scanDummyBtn,SIGNAL(clicked()),this,SLOT(Slot_ScanCont_click()));
+    connect(ui->surveyBtn,SIGNAL(clicked()),this,SLOT(Slot_Survey_click()));
+    connect(ui->trackStartBtn,SIGNAL(clicked()),this,SLOT(Slot_trackStart_click()));
+    connect(ui->trackStopBtn,SIGNAL(clicked()),this,SLOT(Slot_trackStop_click()));
 
     connect(ui->copyBtn, SIGNAL(clicked()), this, SLOT(Slot_copy()));
 
@@ -77,20 +100,24 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->monStartBtn,SIGNAL(clicked()),this,SLOT(Slot_monStart_click()));
     connect(ui->monStopBtn,SIGNAL(clicked()),this,SLOT(Slot_monStop_click()));
 
-    QCheckBox *ctrls[] = {ui->plotz_chk,ui->plotx_chk,ui->plotr_chk,NULL};
+    QCheckBox *ctrls[] = {ui->plotz_chk,ui->plotx_chk,ui->plotr_chk,ui->plots21_chk,NULL};
     for (int i=0; ctrls[i]; i++)
         connect(ctrls[i], SIGNAL(stateChanged(int)), this, SLOT(Slot_plot_change(int)));
+    connect(ui->sweepavg_cb, SIGNAL(currentIndexChanged(int)), this, SLOT(Slot_sweepavg_change(int)));
+    connect(ui->sweepavg_n, SIGNAL(valueChanged(int)), this, SLOT(Slot_sweepavg_change(int)));
+    connect(ui->hold_chk, SIGNAL(stateChanged(int)), this, SLOT(Slot_sweepavg_change(int)));
 
-    deviceIO = new DeviceIO();
-    if (deviceIO->IsUp())
-        ui->label_Status->setText((QString)"Connected");
-    else
-        ui->label_Status->setText((QString)"Disconnected");
+    //The window shows straight away, the device is found in the background
+    connect(&connectwatcher, SIGNAL(finished()), this, SLOT(Slot_connect_done()));
+    deviceIO = NULL;
+    plotsweep = 0;
+    start_connect();
 
 
     ui->band_cb->setCurrentIndex(14);
 
-    ui->scan_data->setHorizontalHeaderLabels(QStringList() << "freq" << "SWR" << "Z" << "R" << "X");
+    scan_model = new ScanDataModel(&scandata, this);
+    ui->scan_data->setModel(scan_model);
 
     ui->canvas1->cursor = ui->cursor;
 
@@ -101,6 +128,16 @@ MainWindow::MainWindow(QWidget *parent) :
     montimer.setParent(this);
     connect(&montimer, SIGNAL(timeout()), this, SLOT(Slot_montimer_timeout()));
 
+    tracker = NULL;
+    trackthinned = 0;
+    survey = NULL;
+    tracktimer.setParent(this);
+    tracktimer.setSingleShot(true);
+    connect(&tracktimer, SIGNAL(timeout()), this, SLOT(Slot_tracktimer_timeout()));
+
+    scanacq = &scandata;
+    scandata.swr_bw_max = scanback.swr_bw_max = Config::swr_bw_max;
+
     timer = new QTimer(this);
     timer->setSingleShot(true);
     connect(timer, SIGNAL(timeout()), this, SLOT(Slot_Update()));
@@ -109,13 +146,20 @@ MainWindow::MainWindow(QWidget *parent) :
 void MainWindow::Slot_tabWidget_change(int)
 {
     montimer.stop();
+    monitor.Stop();
+    Slot_trackStop_click();
 
+    if (bContRun && !bIsScanning && deviceIO->IsUp())
+        deviceIO->Cmd_Off();
     bContRun = false;
     timer->stop();
 }
 
 MainWindow::~MainWindow()
 {
+    connectwatcher.waitForFinished();
+    monitor.Stop();
+    delete tracker;
     delete timer;
     delete deviceIO;
     delete ui;
@@ -128,25 +172,28 @@ void MainWindow::RaiseEvent(event_t event,int arg)
       case progress_event:
         ui->progressBar->setValue(arg);
         break;
+      case points_event:
+        if (scanacq!=&scandata)
+            break;  //Back buffer, shown when complete
+        scan_model->Update();
+        draw_graph1_points();
+        break;
+      case sweep_started_event:
+        plotsweep = deviceIO->Sweep();
+        ui->progressBar->setValue(0);
+        break;
+      case error_event:
+        ui->label_Status->setText((QString)"Disconnected");
+        break;
+      default:
+        break;
     }
 }
 
 void MainWindow::populate_table()
 {
-    //Populate data table
-    ui->scan_data->setRowCount(scandata.points.size());
-
-    for (unsigned int i=0;i<scandata.points.size();i++)
-    {
-        Sample *point = &scandata.points[i];
-
-        ui->scan_data->setItem(i, 0, new QTableWidgetItem(QString("%1").arg(point->freq/1000000.0,0,'f')));
-        ui->scan_data->setItem(i, 1, new QTableWidgetItem(QString("%1").arg(point->swr)));
-        ui->scan_data->setItem(i, 2, new QTableWidgetItem(QString("%1").arg(point->Z)));
-        ui->scan_data->setItem(i, 3, new QTableWidgetItem(QString("%1").arg(point->R)));
-        ui->scan_data->setItem(i, 4, new QTableWidgetItem(QString("%1").arg(point->X)));
-        //ui->scan_data->setItem(i, 5, new QTableWidgetItem(QString("%1").arg(point->X2)));
-    }
+    //The view formats the visible cells itself, only new rows need announcing
+    scan_model->Update();
 }
 
 void MainWindow::draw_graph1()
@@ -173,6 +220,12 @@ void MainWindow::draw_graph1()
     //if (ui->canvas1->xtrace->enabled && scandata.points[scandata.X_max_idx].X>scale->vmax) scale->vmax=scandata.points[scandata.X_max_idx].X;
     if (ui->canvas1->xtrace->enabled) scale->Expand(scandata.points[scandata.X_min_idx].X,scandata.points[scandata.X_max_idx].X);
     if (ui->canvas1->rtrace->enabled && scandata.points[scandata.R_max_idx].R>scale->vmax) scale->vmax=scandata.points[scandata.R_max_idx].R;
+    if (ui->canvas1->s21trace->enabled)
+    {
+        scale->vmin = scale->vmax = scandata.points[0].S21dB();
+        for (unsigned int i=1;i<scandata.points.size();i++)
+            scale->Expand(scandata.points[i].S21dB(),scandata.points[i].S21dB());
+    }
     if (scale->vmax==0.0) scale->vmax=1.0;
     scale->SetIncAuto();
     scale->SetMinAuto();
@@ -193,6 +246,45 @@ void MainWindow::draw_graph1()
     for (unsigned int i=0;i<scandata.points.size();i++)
         ui->canvas1->rtrace->points[i] = scandata.points[i].R;
 
+    ui->canvas1->s21trace->points.resize(scandata.points.size());
+    for (unsigned int i=0;i<scandata.points.size();i++)
+        ui->canvas1->s21trace->points[i] = scandata.points[i].S21dB();
+
+    //Aggregates only exist in continuous mode and only on the grid on display
+    GraphTrace *avg = ui->canvas1->swravgtrace;
+    avg->points.clear();
+    if (sweepavg.average.points.size()==scandata.points.size())
+        for (unsigned int i=0;i<scandata.points.size();i++)
+            avg->points.push_back(sweepavg.average.points[i].swr);
+    ui->canvas1->swrmaxtrace->points.clear();
+    ui->canvas1->swrmintrace->points.clear();
+    if (ui->hold_chk->isChecked() && sweepavg.swr_max.size()==scandata.points.size())
+    {
+        ui->canvas1->swrmaxtrace->points = sweepavg.swr_max;
+        ui->canvas1->swrmintrace->points = sweepavg.swr_min;
+        double v = *std::max_element(sweepavg.swr_max.begin(),sweepavg.swr_max.end());
+        ui->canvas1->yscale1->Expand(1.0,v>Config::swr_max ? Config::swr_max : v);
+        ui->canvas1->yscale1->SetIncAuto();
+    }
+
+    ui->canvas1->swrtrace->span = 0;
+    ui->canvas1->ztrace->span = 0;
+    ui->canvas1->xtrace->span = 0;
+    ui->canvas1->rtrace->span = 0;
+    ui->canvas1->s21trace->span = 0;
+    ui->canvas1->swravgtrace->span = 0;
+    ui->canvas1->swrmaxtrace->span = 0;
+    ui->canvas1->swrmintrace->span = 0;
+
+    ui->canvas1->swrtrace->Invalidate();
+    ui->canvas1->ztrace->Invalidate();
+    ui->canvas1->xtrace->Invalidate();
+    ui->canvas1->rtrace->Invalidate();
+    ui->canvas1->s21trace->Invalidate();
+    ui->canvas1->swravgtrace->Invalidate();
+    ui->canvas1->swrmaxtrace->Invalidate();
+    ui->canvas1->swrmintrace->Invalidate();
+
     ui->canvas1->ZTargetline->val = Config::Z_Target;
     ui->canvas1->SWRTargetline->val = Config::swr_bw_max;
 
@@ -209,6 +301,91 @@ void MainWindow::draw_graph1()
 
 }
 
+// Prepares the graph to be filled point by point while a sweep is running
+void MainWindow::draw_graph1_begin()
+{
+    GraphCanvas *canvas = ui->canvas1;
+    GraphTrace *traces[] = {canvas->swrtrace,canvas->ztrace,canvas->xtrace,canvas->rtrace,canvas->s21trace,
+                            canvas->swravgtrace,canvas->swrmaxtrace,canvas->swrmintrace,NULL};
+
+    canvas->xscale->vmin = scandata.freq_start;
+    canvas->xscale->vmax = scandata.freq_end;
+    canvas->xscale->SetIncAuto();
+
+    //The Y scales of the previous sweep are kept and only grown as new points need it
+    canvas->yscale1->vmin = 1.0;
+    if (canvas->yscale1->vmax<=canvas->yscale1->vmin)
+    {
+        canvas->yscale1->vmax = 2.0;
+        canvas->yscale1->SetIncAuto();
+    }
+
+    for (int i=0; traces[i]; i++)
+    {
+        traces[i]->points.clear();
+        traces[i]->span = scandata.GetPointCount()+1;
+        traces[i]->Invalidate();
+    }
+    plotreader.Skip();
+
+    canvas->update();
+}
+
+// Appends the points queued since the last batch
+void MainWindow::draw_graph1_points()
+{
+    GraphCanvas *canvas = ui->canvas1;
+    unsigned int first = canvas->swrtrace->points.size();
+    bool rescale = false;
+    MeasuredPoint batch[256];
+    int n;
+
+    while ((n = plotreader.Read(batch, 256)) > 0)
+    {
+        for (int k=0; k<n; k++)
+        {
+            if (batch[k].sweep!=plotsweep)
+                continue;   //e.g. a single reading
+
+            //Points the reader lost are taken from the scan, it holds them all
+            unsigned int index = batch[k].index;
+            while (canvas->swrtrace->points.size()<index && canvas->swrtrace->points.size()<scandata.points.size())
+                rescale |= plot_point(scandata.points[canvas->swrtrace->points.size()]);
+            if (canvas->swrtrace->points.size()==index)
+                rescale |= plot_point(batch[k].sample);
+        }
+    }
+
+    unsigned int last = canvas->swrtrace->points.size();
+    if (last<=first)
+        return;
+    if (rescale)
+        canvas->update();
+    else
+        canvas->UpdatePoints(first>0 ? first-1 : 0, last-1);
+}
+
+// Adds a point to the live traces, returns true if a scale had to grow
+bool MainWindow::plot_point(const Sample &point)
+{
+    GraphCanvas *canvas = ui->canvas1;
+    bool rescale = false;
+
+    canvas->swrtrace->points.push_back(point.swr);
+    canvas->ztrace->points.push_back(point.Z);
+    canvas->xtrace->points.push_back(point.X);
+    canvas->rtrace->points.push_back(point.R);
+    canvas->s21trace->points.push_back(point.S21dB());
+
+    if (point.suspect)
+        return false;   //Stays in the trace, but does not stretch the scales
+    rescale |= canvas->yscale1->Fit(point.swr>Config::swr_max ? Config::swr_max : point.swr);
+    if (canvas->ztrace->enabled) rescale |= canvas->yscale2->Fit(point.Z);
+    if (canvas->xtrace->enabled) rescale |= canvas->yscale2->Fit(point.X);
+    if (canvas->rtrace->enabled) rescale |= canvas->yscale2->Fit(point.R);
+    if (canvas->s21trace->enabled) rescale |= canvas->yscale2->Fit(point.S21dB());
+    return rescale;
+}
 
 void MainWindow::Slot_Update()
 {
@@ -216,7 +393,7 @@ void MainWindow::Slot_Update()
         ScanProc();
 
     if (bContRun)
-        timer->start(500);
+        timer->start(0);    //Next sweep straight away, the last one is painted meanwhile
     else
         timer->stop();
 }
@@ -238,6 +415,8 @@ void MainWindow::Slot_ScanCont_click()  /* Continuous */
     {
         bContRun = false;
         timer->stop();
+        if (!bIsScanning && deviceIO->IsUp())
+            deviceIO->Cmd_Off();
     }
     else
     {
@@ -249,6 +428,81 @@ void MainWindow::Slot_ScanCont_click()  /* Continuous */
     }
 }
 
+void MainWindow::Slot_Survey_click()
+{
+    if (bIsScanning || !deviceIO->IsUp())
+        return;
+
+    bContRun = false;
+    timer->stop();
+
+    BandSurvey bands(deviceIO);
+    bands.runner.swr_bw_max = Config::swr_bw_max;
+    bands.BuildPlan(ui->point_count->value());
+
+    bIsScanning = true;
+    scanacq = &scanback;    //Not drawn live, the bands are shown at the end
+    bands.Run(this);
+    scanacq = &scandata;
+    bIsScanning = false;
+
+    if (bands.summary.empty())
+        return;
+    qApp->clipboard()->setText(bands.Report());
+
+    //Every band in a table, the selected one is shown on the graph
+    QDialog dlg(this);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+    QTableWidget *table = new QTableWidget(bands.summary.size(), 6, &dlg);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dlg);
+    int best = bands.Best(), bestrow = 0;
+
+    dlg.setWindowTitle("Band Survey");
+    layout->addWidget(new QLabel(QString("%1 bands swept. Select a band to show its sweep, "
+                                         "the summary has been copied to the clipboard.")
+                                 .arg(bands.summary.size()), &dlg));
+    table->setHorizontalHeaderLabels(QStringList() << "band" << "points" << "SWR min" << "f (MHz)" << "Z" << "bw (MHz)");
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    for (unsigned int i=0;i<bands.summary.size();i++)
+    {
+        const BandSummary &s = bands.summary[i];
+
+        table->setItem(i,0,new QTableWidgetItem(s.name));
+        table->setItem(i,1,new QTableWidgetItem(QString::number(s.points)));
+        table->setItem(i,2,new QTableWidgetItem(QString::number(s.swr_min,'f',2)));
+        table->setItem(i,3,new QTableWidgetItem(QString::number(s.f_res/1000000.0,'f',4)));
+        table->setItem(i,4,new QTableWidgetItem(QString::number(s.Z_res,'f',1)));
+        table->setItem(i,5,new QTableWidgetItem(QString::number((s.bw_hi-s.bw_lo)/1000000.0,'f',3)));
+        if (s.result==best)
+            bestrow = i;
+    }
+    table->resizeColumnsToContents();
+    layout->addWidget(table);
+    layout->addWidget(buttons);
+    connect(buttons, SIGNAL(rejected()), &dlg, SLOT(reject()));
+    connect(table, SIGNAL(currentCellChanged(int,int,int,int)), this, SLOT(Slot_survey_select(int)));
+
+    survey = &bands;
+    table->selectRow(bestrow);   //Starts with the best match on the graph
+    dlg.resize(520, 420);
+    dlg.exec();
+    survey = NULL;
+}
+
+// Shows the sweep of a band selected in the survey results
+void MainWindow::Slot_survey_select(int row)
+{
+    if (!survey || row<0 || row>=(int)survey->summary.size())
+        return;
+
+    scandata = survey->runner.results[survey->summary[row].result].scan;
+    scan_model->Reload();
+    draw_graph1();
+}
+
 void MainWindow::ScanProc()
 {
     if (deviceIO->IsUp())
@@ -256,24 +510,75 @@ void MainWindow::ScanProc()
     else
         ui->label_Status->setText((QString)"Disconnected");
 
-    scandata.freq_start = (ui->fcentre->value()-ui->fspan->value()/2.0)*1000000;
-    scandata.freq_end = (ui->fcentre->value()+ui->fspan->value()/2.0)*1000000;
-    scandata.SetPointCount(ui->point_count->value());
+    //Continuous sweeps fill a back buffer while the previous sweep stays on display,
+    //single sweeps are drawn live as they are measured
+    ScanData *acq = bContRun ? &scanback : &scandata;
+
+    acq->freq_start = (ui->fcentre->value()-ui->fspan->value()/2.0)*1000000;
+    acq->freq_end = (ui->fcentre->value()+ui->fspan->value()/2.0)*1000000;
+    acq->SetPointCount(ui->point_count->value());
+    acq->thru = ui->plots21_chk->isChecked();   //Before the table is cleared, it sets the columns
 
     if (deviceIO->IsUp())
     {
+        set_averaging();
+        deviceIO->SetThru(acq->thru);   //A plan or survey may have left it changed
         bIsScanning = true;
-        deviceIO->Cmd_Scan((long)(scandata.freq_start),
-                  (long)(scandata.freq_end),
-                  (long)((scandata.freq_end-scandata.freq_start)/scandata.GetPointCount()),
+        scanacq = acq;
+        if (acq==&scandata)
+        {
+            scan_model->Clear();
+            draw_graph1_begin();
+        }
+        deviceIO->Cmd_Scan(*acq,
+                  (long)(acq->freq_start),
+                  (long)(acq->freq_end),
+                  (long)((acq->freq_end-acq->freq_start)/acq->GetPointCount()),
                   this);
-        deviceIO->Cmd_Off();
+        if (acq!=&scandata)
+        {
+            scandata.Swap(*acq);
+            scan_model->Reload();
+            sweepavg.Add(scandata);
+        }
+        else
+            sweepavg.Reset();
+        scanacq = &scandata;
+        if (!bContRun)
+            deviceIO->Cmd_Off();
         populate_table();
         draw_graph1();
+        QStringList notes;
+        if (ui->adaptive_chk->isChecked())
+            notes << QString("%1 readings per point").arg(deviceIO->ReadingsPerPoint(),0,'f',2);
+        if (ui->deglitch_chk->isChecked())
+        {
+            int found, kept;
+            deviceIO->GlitchCounts(found, kept);
+            notes << QString("%1 glitches re-measured, %2 suspect").arg(found-kept).arg(kept);
+        }
+        if (!notes.isEmpty())
+            statusBar()->showMessage(notes.join(", "), 5000);
         bIsScanning = false;
     }
 }
 
+// Averaging for the sweeps started from the Scan controls
+void MainWindow::set_averaging()
+{
+    if (ui->adaptive_chk->isChecked())
+    {
+        deviceIO->SetSamples(1);
+        deviceIO->SetAdaptive(ui->avg_count->value(), Config::adapt_tol);
+    }
+    else
+    {
+        deviceIO->SetSamples(ui->avg_count->value());
+        deviceIO->SetAdaptive(0);
+    }
+    deviceIO->SetDeglitch(ui->deglitch_chk->isChecked());
+}
+
 void MainWindow::Slot_cursor_move(double pos)
 {
 //printf("pos=%lf\n",pos);
@@ -284,10 +589,15 @@ void MainWindow::Slot_cursor_move(double pos)
 
     Sample *sample = &scandata.points[n];
 
-    ui->cursor_disp->setText(QString("f=%1MHz, swr=%2, Z=%3%4")
+    QString text = QString("f=%1MHz, swr=%2, Z=%3%4")
             .arg(sample->freq/1000000)
             .arg(sample->swr,0,'f',2)
-            .arg(sample->Z,0,'f',2).arg(QChar(0x03A9)));
+            .arg(sample->Z,0,'f',2).arg(QChar(0x03A9));
+    if (sample->suspect)
+        text += " (suspect)";
+    if (scandata.thru)
+        text += QString(", S21=%1dB %2%3").arg(sample->S21dB(),0,'f',2).arg(sample->S21deg(),0,'f',1).arg(QChar(0x00B0));
+    ui->cursor_disp->setText(text);
 }
 
 void MainWindow::set_band(double f, double span)
@@ -309,29 +619,8 @@ void MainWindow::Slot_band_change(int idx)
     ui->fcentre->blockSignals(true);
     ui->fspan->blockSignals(true);
 
-    switch (idx)
-    {
-        case 0: break;
-        case 1: set_band(1.5, 1.0);  break;     //160m
-        case 2: set_band(3.5, 3.0);  break;     //80m
-        case 3: set_band(6.5, 3.0);  break;     //40m
-        case 4: set_band(9.5, 3.0);  break;     //30m
-        case 5: set_band(12.0, 2.0);  break;    //25m
-        case 6: set_band(15.0, 4.0);  break;    //20m
-        case 7: set_band(18.0, 2.0);  break;    //17m
-        case 8: set_band(21.0, 4.0);  break;    //15m
-        case 9: set_band(24.5, 3.0);  break;    //12m
-        case 10: set_band(27.0,	2.0); break;    //11m
-        case 11: set_band(29.5,	3.0); break;    //10m
-        case 12: set_band(40,	18.0); break;   //8m
-        case 13: set_band(51,	4.0); break;    //6m
-        case 14: set_band(16.5,	27.0); break;   //HF (3-30MHz)
-        case 15: set_band(27.5,	5.0); break;    //12-10m (25-30MHz)
-        case 16: set_band(13.5,	5.0); break;    //RFID HF
-        case 17: set_band(115.5,229.0); break;  //1-230MHz
-        case 18: set_band(223.5,3.0); break;    //1.25m
-        case 19: set_band(435.0, 30.0); break;  //70cm
-    }
+    if (idx>0 && idx<Bands::count)
+        set_band(Bands::table[idx].centre, Bands::table[idx].span);
 
     ui->band_cb->blockSignals(false);
     ui->fcentre->blockSignals(false);
@@ -372,13 +661,34 @@ void MainWindow::Slot_point_count_change(int)
 
 void MainWindow::Slot_plot_change(int)
 {
-    ui->canvas1->ztrace->enabled = ui->plotz_chk->checkState()==Qt::Checked;
-    ui->canvas1->xtrace->enabled = ui->plotx_chk->checkState()==Qt::Checked;
-    ui->canvas1->rtrace->enabled = ui->plotr_chk->checkState()==Qt::Checked;
+    //S21 in dB and the impedances would share the right scale, a thru sweep shows S21 alone
+    bool s21 = ui->plots21_chk->checkState()==Qt::Checked;
+
+    ui->canvas1->ztrace->enabled = !s21 && ui->plotz_chk->checkState()==Qt::Checked;
+    ui->canvas1->xtrace->enabled = !s21 && ui->plotx_chk->checkState()==Qt::Checked;
+    ui->canvas1->rtrace->enabled = !s21 && ui->plotr_chk->checkState()==Qt::Checked;
+    ui->canvas1->s21trace->enabled = s21;
+    ui->canvas1->yscale2->title = s21 ? QString("|S21| dB") : QString("Z,R,X %1").arg(QChar(0x03A9));
+    ui->plotz_chk->setEnabled(!s21);
+    ui->plotx_chk->setEnabled(!s21);
+    ui->plotr_chk->setEnabled(!s21);
+    if (deviceIO)
+        deviceIO->SetThru(s21);
     draw_graph1();
 //    ui->canvas1->update();
 }
 
+// Aggregates start again from the next continuous sweep
+void MainWindow::Slot_sweepavg_change(int)
+{
+    static const SweepAverager::mode_t modes[] = {SweepAverager::mode_off,SweepAverager::mode_ema,SweepAverager::mode_boxcar};
+
+    sweepavg.SetMode(modes[ui->sweepavg_cb->currentIndex()],ui->sweepavg_n->value());
+    sweepavg.Reset();
+    ui->sweepavg_n->setEnabled(ui->sweepavg_cb->currentIndex()!=0);
+    draw_graph1();
+}
+
 void MainWindow::Slot_Load()
 {
     QString fileName = QFileDialog::getOpenFileName(this,"Open Layout",Config::dir_data,"Scan Data (*.analyzer)");
@@ -422,7 +732,7 @@ void MainWindow::Slot_Load()
           Config::write();
         }
 
-        populate_table();
+        scan_model->Reload();   //Every row and maybe the S21 columns changed
         draw_graph1();
 
         ui->fcentre->setValue((scandata.freq_end+scandata.freq_start)/2000000.0);
@@ -462,10 +772,28 @@ void MainWindow::toDom(QDomDocument &doc)
 
 void MainWindow::Slot_Save()
 {
-    QString filename = QFileDialog::getSaveFileName(this,"Save Scan Data As",Config::dir_data,"Scan Data (*.analyzer)");
+    QString filter;
+    QString filename = QFileDialog::getSaveFileName(this,"Save Scan Data As",Config::dir_data,
+                                                    "Scan Data (*.analyzer);;Touchstone 2-port (*.s2p)",&filter);
     if (filename.isEmpty())
       return;
 
+    if (filter.contains("s2p"))
+    {
+        if (!filename.endsWith(".s2p",Qt::CaseInsensitive))
+            filename += ".s2p";
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QMessageBox::warning(this, tr("Analyzer"), tr("Cannot write file %1:\n%2.").arg(filename).arg(file.errorString()));
+            return;
+        }
+        QTextStream ts(&file);
+        scandata.toTouchstone2(ts);
+        file.close();
+        return;
+    }
+
 //    if (!copy)
 //      setCurrentFile(fileName);	// Set filename & layoutname here because layoutname is written to the file.
 
@@ -492,16 +820,194 @@ void MainWindow::Slot_Save()
     }
 }
 
+void MainWindow::Slot_RunPlan()
+{
+    if (bIsScanning || !deviceIO->IsUp())
+        return;
+
+    QString fileName = QFileDialog::getOpenFileName(this,"Run Sweep Plan",Config::dir_data,"Sweep Plan (*.xml)");
+    if (fileName.isEmpty())
+        return;
+
+    SweepPlan plan;
+    QString error;
+    if (!plan.Load(fileName, error))
+    {
+        QMessageBox::warning(this, tr("Analyzer"), error);
+        return;
+    }
+
+    montimer.stop();
+    monitor.Stop();
+    bContRun = false;
+    timer->stop();
+
+    PlanRunner runner(deviceIO);
+    runner.swr_bw_max = Config::swr_bw_max;
+
+    bIsScanning = true;
+    scanacq = &scanback;    //Not drawn live, the last sweep is shown at the end
+    runner.Run(plan, this);
+    scanacq = &scandata;
+    bIsScanning = false;
+
+    if (!runner.WriteOutputs(plan, error))
+        QMessageBox::warning(this, tr("Analyzer"), error);
+
+    if (!runner.results.empty())
+    {
+        scandata.Swap(runner.results.back().scan);
+        scan_model->Reload();
+        draw_graph1();
+    }
+
+    statusBar()->showMessage(QString("Sweep plan done, %1 sweeps").arg(runner.results.size()), 5000);
+}
+
 void MainWindow::Slot_menuDevice_Show()
 {
 }
 
 void MainWindow::Slot_menuDevice_Select()
 {
-  if (deviceIO)
-      delete deviceIO;
+  if (bIsScanning || connectwatcher.isRunning())
+      return;
+
+  montimer.stop();
+  monitor.Stop();
+  Slot_trackStop_click();
+  start_connect();
+}
+
+void MainWindow::start_connect()
+{
+  delete deviceIO;
+
+  deviceIO = new DeviceIO(false);
+  deviceIO->SetQueue(&pointqueue);
+  deviceIO->SetEventRate(Config::display_rate);
+  deviceIO->SetThru(ui->plots21_chk->isChecked());
+  Slot_HostCal_toggled(ui->actionHostCal->isChecked());
+
+  ui->label_Status->setText((QString)"Connecting...");
+  connectwatcher.setFuture(QtConcurrent::run(deviceIO, &DeviceIO::Connect));
+}
+
+void MainWindow::Slot_Calibrate()
+{
+  static const char *names[] = {"OPEN", "SHORT", "LOAD (50 Ohm)"};
+
+  if (bIsScanning || !deviceIO->IsUp())
+      return;
+
+  montimer.stop();
+  monitor.Stop();
+  Slot_trackStop_click();
+  bContRun = false;
+  timer->stop();
+
+  Calibration cal;
+  cal.SetGrid((ui->fcentre->value()-ui->fspan->value()/2.0)*1000000,
+              (ui->fcentre->value()+ui->fspan->value()/2.0)*1000000,
+              ui->point_count->value()+1);
+
+  for (int s=Calibration::open_std; s<=Calibration::load_std; s++)
+  {
+      if (QMessageBox::information(this, "Calibration",
+                                   QString("Connect the %1 standard at the reference plane.").arg(names[s]),
+                                   QMessageBox::Ok | QMessageBox::Cancel) != QMessageBox::Ok)
+          return;
+
+      std::vector<cplx> gamma;
+      deviceIO->SetSamples(ui->avg_count->value());
+      bIsScanning = true;
+      bool ok = deviceIO->Cmd_ScanRaw(gamma, cal.freqs, this);
+      bIsScanning = false;
+      if (!ok)
+      {
+          QMessageBox::warning(this, "Calibration", "The device stopped responding, calibration abandoned.");
+          return;
+      }
+      cal.SetStandard((Calibration::standard_t)s, gamma);
+  }
+  deviceIO->Cmd_Off();
+
+  calibration = cal;
+  hostcal = &calibration;
+  ui->actionSaveCal->setEnabled(true);
+  ui->actionHostCal->setEnabled(true);
+  ui->actionHostCal->setChecked(true);
+  Slot_HostCal_toggled(true);
+}
+
+void MainWindow::Slot_HostCal_toggled(bool on)
+{
+  deviceIO->SetCalibration(on && hostcal && hostcal->IsComplete() ? hostcal : NULL);
+}
+
+void MainWindow::Slot_SaveCal()
+{
+  QString error;
+
+  if (!hostcal)
+      return;
+
+  bool ok;
+  QString name = QInputDialog::getText(this, "Save Calibration", "Name of the fixture or cable:",
+                                       QLineEdit::Normal, hostcal->name, &ok).trimmed();
+  if (!ok || name.isEmpty())
+      return;
+
+  hostcal->name = name;
+  if (!calstore.Save(*hostcal, error))
+  {
+      QMessageBox::warning(this, "Save Calibration", error);
+      return;
+  }
+  Slot_HostCal_toggled(ui->actionHostCal->isChecked());
+}
+
+void MainWindow::Slot_LoadCal()
+{
+  QString error;
+  QStringList names = calstore.Names();
+
+  if (bIsScanning)
+      return;
+  if (names.isEmpty())
+  {
+      QMessageBox::information(this, "Load Calibration", QString("No calibrations saved in %1").arg(Config::dir_cal));
+      return;
+  }
+
+  bool ok;
+  QString name = QInputDialog::getItem(this, "Load Calibration", "Calibration:", names, 0, false, &ok);
+  if (!ok)
+      return;
+
+  Calibration *cal = calstore.Get(name, error);
+  if (!cal)
+  {
+      QMessageBox::warning(this, "Load Calibration", error);
+      return;
+  }
+
+  //Stop any sweep using the old set before switching
+  monitor.Stop();
+  Slot_trackStop_click();
+  hostcal = cal;
+  ui->actionSaveCal->setEnabled(true);
+  ui->actionHostCal->setEnabled(true);
+  ui->actionHostCal->setChecked(true);
+  Slot_HostCal_toggled(true);
+}
 
-  deviceIO = new DeviceIO();
+void MainWindow::Slot_connect_done()
+{
+  if (deviceIO->IsUp())
+      ui->label_Status->setText((QString)"Connected");
+  else
+      ui->label_Status->setText((QString)"Disconnected");
 }
 
 void MainWindow::Slot_about()
@@ -518,6 +1024,7 @@ void MainWindow::Slot_Settings()
 
     if (dlg.exec() == QDialog::Accepted)
     {
+      scandata.swr_bw_max = scanback.swr_bw_max = Config::swr_bw_max;
       scandata.UpdateStats();
       draw_graph1();
     }
@@ -525,21 +1032,21 @@ void MainWindow::Slot_Settings()
 
 void MainWindow::Slot_copy()
 {
-  QString txt("freq\tSWR\tZ\tR\tX\n");
+  QString txt;
+  QTextStream ts(&txt);
 
-  for (unsigned int i=0;i<scandata.points.size();i++)
-     txt += QString("%1\t%2\t%3\t%4\t%5\n")
-             .arg(scandata.points[i].freq/1000000.0,0,'f')
-             .arg(scandata.points[i].swr)
-             .arg(scandata.points[i].Z)
-             .arg(scandata.points[i].R)
-             .arg(scandata.points[i].X);
+  scandata.toCsv(ts,'\t');
+  ts.flush();
 
   qApp->clipboard()->setText(txt);
 }
 
 void MainWindow::Slot_monStart_click()
 {
+    //A sweep pumps events while it runs, the monitor thread must not measure in between
+    if (bIsScanning || tracker)
+        return;
+
     bContRun = false;
     timer->stop();
 
@@ -566,19 +1073,36 @@ void MainWindow::Slot_monStart_click()
     ui->X_Bar->value = 0;
     ui->X_Bar->SetIncAuto();
 
-    if (deviceIO->IsUp())
+    ui->monstats->setText("");
+
+    //The list replaces the single frequency when given
+    std::vector<long> freqs;
+    QStringList list = ui->monlist->text().split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts);
+    for (int i=0; i<list.size(); i++)
     {
-        Sample sample;
-        deviceIO->Cmd_Single((long)(ui->monfreq->value()*1000000), sample);
+        bool ok;
+        long f = (long)(list[i].toDouble(&ok)*1000000);
+        if (ok && f>=FMIN && f<=FMAX)
+            freqs.push_back(f);
     }
+    if (freqs.empty())
+        freqs.push_back((long)(ui->monfreq->value()*1000000));
+
+    ui->monbars->swr_max = Config::swr_max;
+    ui->monbars->SetRows(freqs);
+    ui->monbars->setVisible(freqs.size()>1);
+
+    if (!deviceIO->IsUp())
+        return;
 
-    Slot_montimer_timeout();
-    montimer.start((long)(ui->monrate->value()));
+    monitor.Start(deviceIO, freqs, ui->monrate->value());
+    montimer.start(1000/qMax(Config::display_rate, 1));
 }
 
 void MainWindow::Slot_monStop_click()
 {
     montimer.stop();
+    monitor.Stop();
 
     if (deviceIO->IsUp())
         deviceIO->Cmd_Off();
@@ -586,11 +1110,26 @@ void MainWindow::Slot_monStop_click()
 
 void MainWindow::Slot_montimer_timeout()
 {
-    Sample sample;
+    MonitorStats stats;
 
-    if (deviceIO->IsUp())
+    if (!deviceIO->IsUp())
+    {
+        montimer.stop();
+        ui->label_Status->setText((QString)"Disconnected");
+        return;
+    }
+
+    for (int i=1; i<monitor.Channels(); i++)
+        if (monitor.Stats(i, stats))
+            ui->monbars->SetStats(i, stats);
+
+    //The big bars follow the first frequency
+    if (monitor.Channels() && monitor.Stats(0, stats))
     {
-        deviceIO->Cmd_Single((long)(ui->monfreq->value()*1000000), sample);
+        if (monitor.Channels()>1)
+            ui->monbars->SetStats(0, stats);
+
+        Sample &sample = stats.last;
 
         ui->SWR_lbl->setText(QString("%1:1").arg(sample.swr, 0,'f',1));
         ui->SWR_Bar->value = sample.swr;
@@ -607,5 +1146,148 @@ void MainWindow::Slot_montimer_timeout()
         ui->X_lbl->setText(QString("%1").arg(sample.X, 0,'f',1));
         ui->X_Bar->value = sample.X;
         ui->X_Bar->update();
+
+        ui->monstats->setText(QString("%1 samples/s\n\n"
+                                      "SWR %2 .. %3, mean %4\n"
+                                      "Z %5 .. %6, mean %7\n"
+                                      "R %8 .. %9, mean %10\n"
+                                      "X %11 .. %12, mean %13")
+                              .arg(stats.rate, 0,'f',1)
+                              .arg(stats.min.swr, 0,'f',2).arg(stats.max.swr, 0,'f',2).arg(stats.mean.swr, 0,'f',2)
+                              .arg(stats.min.Z, 0,'f',1).arg(stats.max.Z, 0,'f',1).arg(stats.mean.Z, 0,'f',1)
+                              .arg(stats.min.R, 0,'f',1).arg(stats.max.R, 0,'f',1).arg(stats.mean.R, 0,'f',1)
+                              .arg(stats.min.X, 0,'f',1).arg(stats.max.X, 0,'f',1).arg(stats.mean.X, 0,'f',1));
+    }
+}
+
+void MainWindow::Slot_trackStart_click()
+{
+    if (bIsScanning || tracker || !deviceIO->IsUp())
+        return;
+
+    bContRun = false;
+    timer->stop();
+
+    double fstart = (ui->fcentre->value()-ui->fspan->value()/2.0)*1000000;
+    double fend = (ui->fcentre->value()+ui->fspan->value()/2.0)*1000000;
+
+    tracker = new ResonanceTracker(deviceIO);
+    tracker->scan.swr_bw_max = Config::swr_bw_max;
+    tracker->points = ui->trackpoints->value();
+    bTracking = true;
+
+    bIsScanning = true;
+    scanacq = &tracker->scan;   //Not drawn on the scan graph
+    bool ok = tracker->Locate(fstart, fend, ui->point_count->value(), this);
+    scanacq = &scandata;
+    bIsScanning = false;
+
+    if (!ok || !bTracking)
+    {
+        Slot_trackStop_click();
+        return;
+    }
+
+    draw_track(true);
+    tracktimer.start(0);
+}
+
+void MainWindow::Slot_trackStop_click()
+{
+    tracktimer.stop();
+
+    if (!tracker)
+        return;
+    bTracking = false;
+    if (bIsScanning)
+        return;     //Finished in Slot_tracktimer_timeout once the sweep returns
+
+    delete tracker;
+    tracker = NULL;
+    if (deviceIO->IsUp())
+        deviceIO->Cmd_Off();
+}
+
+void MainWindow::Slot_tracktimer_timeout()
+{
+    if (!tracker)
+        return;
+
+    bIsScanning = true;
+    scanacq = &tracker->scan;
+    bool ok = tracker->Step(this);
+    scanacq = &scandata;
+    bIsScanning = false;
+
+    if (!ok && bTracking)
+        statusBar()->showMessage(deviceIO->IsUp() ? tr("Tracking stopped, the resonance was lost")
+                                                  : tr("Tracking stopped, the device was lost"), 5000);
+    if (!ok || !bTracking)
+    {
+        Slot_trackStop_click();
+        return;
+    }
+
+    draw_track();
+    tracktimer.start(0);    //Next sweep straight away
+}
+
+// Plots the tracker history, restart for the first call of a new run
+void MainWindow::draw_track(bool restart)
+{
+    TrackCanvas *canvas = ui->trackcanvas;
+    GraphTrace *freqtrace = canvas->freqtrace, *swrtrace = canvas->swrtrace;
+    const std::vector<TrackPoint> &history = tracker->history;
+    const TrackPoint &last = history.back();
+    unsigned int from = freqtrace->points.size();
+
+    ui->tracklbl->setText(QString("%1 MHz\n%2:1")
+                          .arg(last.freq/1000000.0, 0,'f',6)
+                          .arg(last.swr, 0,'f',2));
+
+    //Only the new points are appended, unless the tracker thinned its history
+    if (restart || tracker->thinned!=trackthinned)
+    {
+        trackthinned = tracker->thinned;
+        freqtrace->points.clear();
+        freqtrace->xpoints.clear();
+        swrtrace->points.clear();
+        swrtrace->xpoints.clear();
+        freqtrace->Invalidate();
+        swrtrace->Invalidate();
+        from = 0;
     }
+
+    if (freqtrace->points.empty())
+    {
+        //Scales of a new run start around its first point, then only grow
+        canvas->xscale->vmin = 0;
+        canvas->xscale->vmax = 1.0;
+        canvas->xscale->SetIncAuto();
+
+        canvas->yscale1->vmin = history[0].freq-500;
+        canvas->yscale1->vmax = history[0].freq+500;
+        canvas->yscale1->SetIncAuto();
+        canvas->yscale1->SetMinAuto();
+        canvas->yscale1->vmax = ceil(canvas->yscale1->vmax/canvas->yscale1->vinc)*canvas->yscale1->vinc;
+
+        canvas->yscale2->vmin = 1.0;
+        canvas->yscale2->vmax = 2.0;
+        canvas->yscale2->SetIncAuto();
+    }
+
+    for (unsigned int i=from;i<history.size();i++)
+    {
+        double swr = history[i].swr>Config::swr_max ? Config::swr_max : history[i].swr;
+
+        freqtrace->points.push_back(history[i].freq);
+        freqtrace->xpoints.push_back(history[i].t);
+        swrtrace->points.push_back(swr);
+        swrtrace->xpoints.push_back(history[i].t);
+        canvas->xscale->Fit(history[i].t);
+        canvas->yscale1->Fit(history[i].freq);
+        canvas->yscale2->Fit(swr);
+    }
+
+    canvas->update();
 }
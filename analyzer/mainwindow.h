@@ -21,11 +21,19 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include "config.h"
 #include "version.h"
 #include "eventreceiver.h"
 #include "deviceio.h"
+#include "scandatamodel.h"
+#include "pointqueue.h"
+#include "monitor.h"
+#include "survey.h"
+#include "tracker.h"
+#include "sweepavg.h"
 
 namespace Ui {
 class MainWindow;
@@ -47,32 +55,65 @@ public:
     QTimer *timer;
     bool bContRun = false;
     bool bIsScanning = false;
+    bool bTracking = false;
 
 private:
     void ScanProc();
     void set_band(double f, double span);
     void set_scan_disp();
     void draw_graph1();
+    void draw_graph1_begin();
+    void draw_graph1_points();
+    bool plot_point(const Sample &point);
+    void draw_track(bool restart = false);
+    void start_connect();
+    void set_averaging();
     void populate_table();
     void toDom(QDomDocument &doc);
     void fromDom(QDomElement &e0);
 
     Ui::MainWindow *ui;
-    QTimer montimer;
+    QTimer montimer;        //Refreshes the monitor bars at display rate
+    Monitor monitor;
+    ScanDataModel *scan_model;
+    ScanData scandata;      //Sweep on display
+    ScanData scanback;      //Acquisition buffer for continuous sweeps
+    ScanData *scanacq;      //Buffer the running sweep is filling
+    PointQueue pointqueue;  //Every measured point, for consumers reading at their own pace
+    PointQueue::Reader plotreader;  //The live graph's place in pointqueue
+    unsigned int plotsweep; //Id of the sweep drawn live
+    SweepAverager sweepavg; //Average and holds over continuous sweeps
+    BandSurvey *survey;     //Results of the survey being shown, NULL otherwise
+    ResonanceTracker *tracker;
+    unsigned int trackthinned;  //Thinning of the tracker history the track graph shows
+    QTimer tracktimer;      //Schedules the next tracking sweep
+    QFutureWatcher<bool> connectwatcher;    //Device discovery running in the background
+    Calibration calibration;    //Last measured set, until it is saved
+    Calibration *hostcal;       //Host side OSL correction, used when actionHostCal is checked
+    CalStore calstore;          //Saved sets, loaded ones keep their interpolated grids
 
 private slots:
     void Slot_ScanSingle_click();
     void Slot_ScanCont_click();
+    void Slot_Survey_click();
+    void Slot_survey_select(int row);
     void Slot_cursor_move(double pos);
     void Slot_band_change(int idx);
     void Slot_fcentre_change(double v);
     void Slot_fspan_change(double v);
     void Slot_point_count_change(int);
     void Slot_plot_change(int);
+    void Slot_sweepavg_change(int);
     void Slot_menuDevice_Show();
     void Slot_menuDevice_Select();
+    void Slot_connect_done();
+    void Slot_Calibrate();
+    void Slot_HostCal_toggled(bool on);
+    void Slot_SaveCal();
+    void Slot_LoadCal();
     void Slot_Load();
     void Slot_Save();
+    void Slot_RunPlan();
     void Slot_Settings();
     void Slot_about();
     void Slot_copy();
@@ -80,6 +121,9 @@ private slots:
     void Slot_monStart_click();
     void Slot_monStop_click();
     void Slot_montimer_timeout();
+    void Slot_trackStart_click();
+    void Slot_trackStop_click();
+    void Slot_tracktimer_timeout();
     void Slot_tabWidget_change(int);
 };
 
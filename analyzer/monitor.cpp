@@ -0,0 +1,144 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "monitor.h"
+
+Monitor::Monitor(QObject *parent) :
+    QThread(parent)
+{
+    deviceIO = NULL;
+    window_ms = 1000;
+    stop = false;
+}
+
+Monitor::~Monitor()
+{
+    Stop();
+}
+
+void Monitor::Start(DeviceIO *device, const std::vector<long> &freqs, int window)
+{
+    Stop();
+
+    deviceIO = device;
+    window_ms = window;
+    channels.resize(freqs.size());
+    for (unsigned int i=0; i<freqs.size(); i++)
+    {
+        channels[i].freq = freqs[i];
+        channels[i].ring.resize(RING_SIZE);
+        channels[i].head = channels[i].count = 0;
+    }
+    if (channels.empty())
+        return;
+
+    stop = false;
+    clock.start();
+    start();
+}
+
+void Monitor::Stop()
+{
+    stop = true;
+    wait();
+}
+
+int Monitor::Channels()
+{
+    return channels.size();
+}
+
+long Monitor::Freq(int channel)
+{
+    return channels[channel].freq;
+}
+
+void Monitor::run()
+{
+    Sample sample;
+    unsigned int i = 0;
+
+    //The channel list is only changed while the thread is stopped
+    while (!stop && deviceIO->IsUp())
+    {
+        Channel &ch = channels[i];
+        if (deviceIO->Cmd_Single(ch.freq, sample) < 0)
+            continue;   //No reading, the device is down and the loop ends
+
+        {
+            QMutexLocker locker(&lock);
+            ch.ring[ch.head].t = clock.elapsed();
+            ch.ring[ch.head].sample = sample;
+            ch.head = (ch.head+1) % RING_SIZE;
+            if (ch.count < RING_SIZE)
+                ch.count++;
+        }
+
+        i = (i+1) % channels.size();
+    }
+}
+
+bool Monitor::Stats(int channel, MonitorStats &stats)
+{
+    QMutexLocker locker(&lock);
+    const Channel &ch = channels[channel];
+
+    if (!ch.count)
+        return false;
+
+    unsigned int i = (ch.head+RING_SIZE-1) % RING_SIZE;
+    qint64 tlast = ch.ring[i].t, tfirst = tlast;
+
+    stats.last = stats.min = stats.max = ch.ring[i].sample;
+    stats.mean.freq = stats.last.freq;
+    stats.mean.swr = stats.mean.Z = stats.mean.R = stats.mean.X = 0;
+    stats.count = 0;
+
+    //Newest to oldest until the window is covered
+    for (unsigned int n=0; n<ch.count; n++, i=(i+RING_SIZE-1)%RING_SIZE)
+    {
+        const Entry &e = ch.ring[i];
+        if (tlast-e.t > window_ms)
+            break;
+        tfirst = e.t;
+        stats.count++;
+
+        stats.mean.swr += e.sample.swr;
+        stats.mean.Z += e.sample.Z;
+        stats.mean.R += e.sample.R;
+        stats.mean.X += e.sample.X;
+
+        if (e.sample.swr < stats.min.swr) stats.min.swr = e.sample.swr;
+        if (e.sample.Z < stats.min.Z) stats.min.Z = e.sample.Z;
+        if (e.sample.R < stats.min.R) stats.min.R = e.sample.R;
+        if (e.sample.X < stats.min.X) stats.min.X = e.sample.X;
+        if (e.sample.swr > stats.max.swr) stats.max.swr = e.sample.swr;
+        if (e.sample.Z > stats.max.Z) stats.max.Z = e.sample.Z;
+        if (e.sample.R > stats.max.R) stats.max.R = e.sample.R;
+        if (e.sample.X > stats.max.X) stats.max.X = e.sample.X;
+    }
+
+    stats.mean.swr /= stats.count;
+    stats.mean.Z /= stats.count;
+    stats.mean.R /= stats.count;
+    stats.mean.X /= stats.count;
+    stats.rate = tlast>tfirst ? (stats.count-1)*1000.0/(tlast-tfirst) : 0;
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <atomic>
+#include <vector>
+
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include "scandata.h"
+#include "deviceio.h"
+
+class MonitorStats
+{
+public:
+    Sample last, min, max, mean;    //Over the samples inside the window
+    int count;                      //Samples inside the window
+    double rate;                    //Samples per second
+};
+
+// Measures a list of frequencies round-robin, back to back, on a worker thread.
+// The latest samples of each frequency are kept in a fixed ring, the display
+// reads statistics over a time window at its own rate.
+class Monitor : public QThread
+{
+public:
+    explicit Monitor(QObject *parent = 0);
+    ~Monitor();
+
+    void Start(DeviceIO *device, const std::vector<long> &freqs, int window_ms);
+    void Stop();
+    int Channels();
+    long Freq(int channel);
+    bool Stats(int channel, MonitorStats &stats);
+
+    static const unsigned int RING_SIZE = 4096;
+
+protected:
+    void run();
+
+private:
+    struct Entry
+    {
+        qint64 t;           //ms since the monitor was started
+        Sample sample;
+    };
+
+    struct Channel
+    {
+        long freq;
+        std::vector<Entry> ring;
+        unsigned int head, count;
+    };
+
+    DeviceIO *deviceIO;
+    int window_ms;
+    std::atomic<bool> stop;
+
+    QMutex lock;            //Guards the rings
+    std::vector<Channel> channels;
+    QElapsedTimer clock;
+};
+
+#endif // MONITOR_H
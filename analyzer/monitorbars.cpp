@@ -0,0 +1,104 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QPainter>
+
+#include "config.h"
+#include "monitorbars.h"
+
+MonitorBars::MonitorBars(QWidget *parent) :
+    QWidget(parent)
+{
+    swr_max = 10;
+
+    font = QFont("Arial",9);
+    font_h = QFontMetrics(font).height();
+    row_h = font_h*2;
+}
+
+void MonitorBars::SetRows(const std::vector<long> &freqs)
+{
+    rows.resize(freqs.size());
+    for (unsigned int i=0; i<freqs.size(); i++)
+    {
+        rows[i].freq = freqs[i];
+        rows[i].valid = false;
+    }
+    setMinimumHeight(rows.size()*row_h);
+    update();
+}
+
+void MonitorBars::SetStats(int row, const MonitorStats &stats)
+{
+    rows[row].stats = stats;
+    rows[row].valid = true;
+    update(0, row*row_h, width(), row_h);
+}
+
+void MonitorBars::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    QFontMetrics fm(font);
+
+    painter.setFont(font);
+
+    int wlabel = fm.width("000.000000 MHz  ");
+    int wtext = fm.width("99.9:1  Z 9999.9  R 9999.9  X -9999.9  ");
+    int xo = wlabel, w = width()-wlabel-wtext;
+    if (w < 20)
+        w = 20;
+    double scale = swr_max>1.0 ? w / (swr_max-1.0) : 0;
+
+    for (unsigned int i=0; i<rows.size(); i++)
+    {
+        const Row &row = rows[i];
+        int yo = i*row_h + font_h/2, h = font_h;
+
+        painter.setPen(Qt::black);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawText(0, yo+fm.ascent(), QString("%1 MHz").arg(row.freq/1000000.0, 0,'f',6));
+        painter.drawRect(xo, yo, w, h);
+
+        if (!row.valid)
+            continue;
+
+        const MonitorStats &s = row.stats;
+        double last = qBound(1.0, s.last.swr, swr_max);
+        double lo = qBound(1.0, s.min.swr, swr_max), hi = qBound(1.0, s.max.swr, swr_max);
+        double mean = qBound(1.0, s.mean.swr, swr_max);
+
+        //Bar for the last sample, green when inside the bandwidth limit
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(s.last.swr<=Config::swr_bw_max ? QBrush(Qt::darkGreen) : QBrush(Qt::blue));
+        painter.drawRect(xo, yo+h/4, (last-1.0)*scale, h/2);
+
+        //Window range and mean
+        painter.setPen(Qt::red);
+        painter.drawLine(xo+(lo-1.0)*scale, yo+h/2, xo+(hi-1.0)*scale, yo+h/2);
+        painter.drawLine(xo+(mean-1.0)*scale, yo, xo+(mean-1.0)*scale, yo+h);
+
+        painter.setPen(Qt::black);
+        painter.drawText(xo+w+fm.width("  "), yo+fm.ascent(),
+                         QString("%1:1  Z %2  R %3  X %4")
+                         .arg(s.last.swr, 0,'f',1)
+                         .arg(s.last.Z, 0,'f',1)
+                         .arg(s.last.R, 0,'f',1)
+                         .arg(s.last.X, 0,'f',1));
+    }
+}
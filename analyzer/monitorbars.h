@@ -0,0 +1,58 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MONITORBARS_H
+#define MONITORBARS_H
+
+#include <vector>
+
+#include <QWidget>
+#include <QFont>
+
+#include "monitor.h"
+
+// One compact row per monitored frequency: the SWR bar shows the last
+// sample, the min..max range of the window and a tick at the mean
+class MonitorBars : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit MonitorBars(QWidget *parent = 0);
+
+    void SetRows(const std::vector<long> &freqs);
+    void SetStats(int row, const MonitorStats &stats);
+
+    double swr_max;
+
+private:
+    struct Row
+    {
+        long freq;
+        bool valid;
+        MonitorStats stats;
+    };
+
+    std::vector<Row> rows;
+    QFont font;
+    int font_h, row_h;
+
+    void paintEvent(QPaintEvent *);
+};
+
+#endif // MONITORBARS_H
@@ -0,0 +1,117 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pointqueue.h"
+
+PointQueue::PointQueue(unsigned int size)
+{
+    unsigned int n = 1;
+    while (n<size)
+        n <<= 1;
+
+    slots = new Slot[n];
+    for (unsigned int i=0;i<n;i++)
+        slots[i].state.store(0,std::memory_order_relaxed);
+    mask = n-1;
+    head.store(0,std::memory_order_relaxed);
+}
+
+PointQueue::~PointQueue()
+{
+    delete[] slots;
+}
+
+// Single producer: callers on more than one thread must serialise their pushes,
+// DeviceIO does so under its device lock
+void PointQueue::Push(unsigned int sweep, unsigned int index, const Sample &sample)
+{
+    uint64_t seq = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[seq & mask];
+
+    slot.state.store(2*seq+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.point.seq = seq;
+    slot.point.sweep = sweep;
+    slot.point.index = index;
+    slot.point.sample = sample;
+
+    slot.state.store(2*(seq+1),std::memory_order_release);
+    head.store(seq+1,std::memory_order_release);
+}
+
+uint64_t PointQueue::Head() const
+{
+    return head.load(std::memory_order_acquire);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PointQueue::Reader::Reader(const PointQueue *q)
+{
+    queue = q;
+    next = q->Head();
+    lost = 0;
+}
+
+// Drops everything pending, reading continues with the next point pushed
+void PointQueue::Reader::Skip()
+{
+    next = queue->Head();
+}
+
+// Copies up to max pending points to out, returns the number copied
+int PointQueue::Reader::Read(MeasuredPoint *out, int max)
+{
+    int n = 0;
+    uint64_t head = queue->Head();
+
+    //Too far behind: skip to the oldest point still in the ring
+    if (head-next > queue->mask+1)
+    {
+        lost += head-(queue->mask+1)-next;
+        next = head-(queue->mask+1);
+    }
+
+    while (n<max && next<head)
+    {
+        const Slot &slot = queue->slots[next & queue->mask];
+
+        uint64_t s1 = slot.state.load(std::memory_order_acquire);
+        if (s1!=2*(next+1))
+        {
+            //Overwritten by the producer meanwhile
+            lost++;
+            next++;
+            continue;
+        }
+        out[n] = slot.point;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t s2 = slot.state.load(std::memory_order_relaxed);
+        if (s2!=s1)
+        {
+            lost++;
+            next++;
+            continue;
+        }
+        n++;
+        next++;
+    }
+    return n;
+}
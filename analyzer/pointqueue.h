@@ -0,0 +1,77 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POINTQUEUE_H
+#define POINTQUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "scandata.h"
+
+class MeasuredPoint
+{
+public:
+    uint64_t seq;           //Position in the queue, increases by one per point
+    unsigned int sweep;     //Sweep the point belongs to
+    unsigned int index;     //Index of the point within its sweep
+    Sample sample;
+};
+
+// Single producer / multiple consumer ring of measured points.
+// The producer never waits: a consumer that falls more than a ring behind
+// skips the points that were overwritten and gets them counted as lost.
+class PointQueue
+{
+public:
+    explicit PointQueue(unsigned int size = 4096);
+    ~PointQueue();
+
+    void Push(unsigned int sweep, unsigned int index, const Sample &sample);
+    uint64_t Head() const;
+
+    class Reader
+    {
+    public:
+        explicit Reader(const PointQueue *q);
+        int Read(MeasuredPoint *out, int max);
+        void Skip();
+
+        uint64_t next;      //Sequence number of the next point to read
+        uint64_t lost;      //Points overwritten before they could be read
+
+    private:
+        const PointQueue *queue;
+    };
+
+private:
+    struct Slot
+    {
+        //Even: 2*(seq+1) when point seq is complete, odd while it is being written
+        std::atomic<uint64_t> state;
+        MeasuredPoint point;
+    };
+
+    Slot *slots;
+    unsigned int mask;
+    std::atomic<uint64_t> head;
+};
+
+#endif // POINTQUEUE_H
@@ -784,6 +784,54 @@ int HID_API_EXPORT_CALL hid_get_serial_number_string(hid_device *dev, wchar_t *s
     return get_device_string(dev, DEVICE_STRING_SERIAL, string, maxlen);
 }
 
+int HID_API_EXPORT_CALL hid_get_device_ids(hid_device *dev, unsigned short *vendor_id, unsigned short *product_id)
+{
+    struct udev *udev;
+    struct udev_device *udev_dev, *hid_dev;
+    struct stat s;
+    int ret = -1;
+
+    udev = udev_new();
+    if (!udev)
+        return -1;
+
+    /* The hidraw node of the handle, then its HID parent which has the IDs */
+    if (fstat(dev->device_handle, &s) < 0) {
+        udev_unref(udev);
+        return -1;
+    }
+    udev_dev = udev_device_new_from_devnum(udev, 'c', s.st_rdev);
+    if (udev_dev) {
+        hid_dev = udev_device_get_parent_with_subsystem_devtype(
+            udev_dev,
+            "hid",
+            NULL);
+        if (hid_dev) {
+            char *serial_number_utf8 = NULL;
+            char *product_name_utf8 = NULL;
+            int bus_type;
+
+            /* parse_uevent_info() only reports all three fields found, the IDs alone are enough */
+            *vendor_id = *product_id = 0;
+            parse_uevent_info(
+                udev_device_get_sysattr_value(hid_dev, "uevent"),
+                &bus_type,
+                vendor_id,
+                product_id,
+                &serial_number_utf8,
+                &product_name_utf8);
+            if (*vendor_id != 0 || *product_id != 0)
+                ret = 0;
+            free(serial_number_utf8);
+            free(product_name_utf8);
+        }
+        udev_device_unref(udev_dev);
+    }
+    udev_unref(udev);
+
+    return ret;
+}
+
 int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index, wchar_t *string, size_t maxlen)
 {
     return -1;
@@ -359,6 +359,18 @@ extern "C" {
         */
         int HID_API_EXPORT_CALL hid_get_serial_number_string(hid_device *device, wchar_t *string, size_t maxlen);
 
+        /** @brief Get the Vendor and Product IDs of an open HID device.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param vendor_id Receives the Vendor ID (VID).
+            @param product_id Receives the Product ID (PID).
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT_CALL hid_get_device_ids(hid_device *device, unsigned short *vendor_id, unsigned short *product_id);
+
         /** @brief Get a string from a HID device, based on its string index.
 
             @ingroup API
@@ -40,32 +40,49 @@
 #endif
 #include <string.h>
 #if defined(__linux__)
+#include <wchar.h>
 #include "hidapi.h"
 #endif
 #include "sark_cmd_defs.h"
 #include "sark_client.h"
 
-/* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 #define TX_TIMEOUT			100
 #define RX_TIMEOUT			220
+#define SARK_VID			0x0483
+#define SARK_PID			0x5750
+#define PATH_SIZE			256
+#define SERIAL_SIZE			64
+#define SEEN_SIZE			4
+
+/* Private typedef -----------------------------------------------------------*/
+#if defined(__linux__)
+typedef struct
+{
+    char tszPath[PATH_SIZE];        /* hidraw node the analyzer was opened on */
+    wchar_t twszSerial[SERIAL_SIZE];    /* its serial number, empty if it has none */
+} Sark_Seen_t;
+#endif
 
 /* Private macro -------------------------------------------------------------*/
 /* External variables --------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 #if defined(__linux__)
 static hid_device *handle = NULL;
+static int bHidInit = 0;                        /* hid_init done for this process */
+static Sark_Seen_t tSeen[SEEN_SIZE];           /* analyzers opened, most recent first */
+static int iSeenCount = 0;
 #endif
 
 /* Private function prototypes -----------------------------------------------*/
-static void Float2Buf (uint8_t tu8Buf[4], float fVal);
-static void Int2Buf (uint8_t tu8Buf[4], uint32_t u32Val);
-static void Buf2Int (uint32_t *pu32Val, uint8_t tu8Buf[4]);
-static void Buf2Float (float *pfVal, uint8_t tu8Buf[4]);
 static void Buf2Short (uint16_t *pu16Val, uint8_t tu8Buf[4]);
 static void Short2Buf (uint8_t tu8Buf[4], uint16_t u16Val);
-static uint16_t Float2Half(float value);
-static float Half2Float(uint16_t value);
+#if defined(__linux__)
+static hid_device *OpenSeen (void);
+static hid_device *OpenEnumerated (void);
+static int IsSeen (hid_device *dev, const Sark_Seen_t *ptSeen);
+static void Remember (const char *tszPath, const wchar_t *twszSerial);
+#endif
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -83,18 +100,148 @@ int Sark_Connect (void)
     if (iRc <= 0)
         return -1;
 #else
-    // Initialize the hidapi library
-    hid_init();
+    // Initialize the hidapi library once per process
+    if (!bHidInit)
+    {
+        if (hid_init() < 0)
+            return -1;
+        bHidInit = 1;
+    }
 
-    // Open the device using the VID, PID,
-    // and optionally the Serial number.
-    handle = hid_open(0x0483, 0x5750, NULL);
+    if (handle != NULL)
+    {
+        hid_close(handle);
+        handle = NULL;
+    }
+
+    // Try the nodes analyzers were last seen on before enumerating
+    handle = OpenSeen();
+    if (handle == NULL)
+        handle = OpenEnumerated();
     if (handle == NULL)
         return -1;
 #endif
     return 1;
 }
 
+#if defined(__linux__)
+/**
+  * @brief Opens the cached node of an analyzer connected before, most
+  *        recent first. A node now taken by another device is skipped.
+  *
+  * @retval Device handle, NULL if none of the analyzers is on its node
+  */
+static hid_device *OpenSeen (void)
+{
+    hid_device *dev;
+    int i;
+
+    for (i = 0; i < iSeenCount; i++)
+    {
+        dev = hid_open_path(tSeen[i].tszPath);
+        if (dev == NULL)
+            continue;
+        if (IsSeen(dev, &tSeen[i]))
+        {
+            Remember(tSeen[i].tszPath, tSeen[i].twszSerial);
+            return dev;
+        }
+        hid_close(dev);
+    }
+    return NULL;
+}
+
+/**
+  * @brief Checks an opened node is still the analyzer cached for it,
+  *        hidraw numbers are reused when devices are replugged
+  *
+  * @retval 1 when the VID, PID and serial number match
+  */
+static int IsSeen (hid_device *dev, const Sark_Seen_t *ptSeen)
+{
+    unsigned short u16Vid, u16Pid;
+    wchar_t twszSerial[SERIAL_SIZE];
+
+    if (hid_get_device_ids(dev, &u16Vid, &u16Pid) < 0 ||
+        u16Vid != SARK_VID || u16Pid != SARK_PID)
+        return 0;
+    if (ptSeen->twszSerial[0] == L'\0')
+        return 1;
+    if (hid_get_serial_number_string(dev, twszSerial, SERIAL_SIZE) < 0)
+        return 0;
+    twszSerial[SERIAL_SIZE-1] = L'\0';
+    return wcscmp(twszSerial, ptSeen->twszSerial) == 0;
+}
+
+/**
+  * @brief Moves an analyzer to the front of the cache, the least recent
+  *        one drops out when it is full
+  */
+static void Remember (const char *tszPath, const wchar_t *twszSerial)
+{
+    Sark_Seen_t tNew;
+    int i;
+
+    memset(&tNew, 0, sizeof(tNew));
+    strncpy(tNew.tszPath, tszPath, PATH_SIZE-1);
+    if (twszSerial != NULL)
+        wcsncpy(tNew.twszSerial, twszSerial, SERIAL_SIZE-1);
+
+    // The same analyzer by serial, or the same node for one without a serial
+    for (i = 0; i < iSeenCount; i++)
+    {
+        if (tNew.twszSerial[0] != L'\0' ? wcscmp(tSeen[i].twszSerial, tNew.twszSerial) == 0
+                                        : strcmp(tSeen[i].tszPath, tNew.tszPath) == 0)
+            break;
+    }
+    if (i == iSeenCount && iSeenCount < SEEN_SIZE)
+        iSeenCount++;
+    if (i == SEEN_SIZE)
+        i = SEEN_SIZE-1;
+    memmove(&tSeen[1], &tSeen[0], i*sizeof(Sark_Seen_t));
+    tSeen[0] = tNew;
+}
+
+/**
+  * @brief Enumerates the analyzers and opens one, preferring the most
+  *        recently connected serial number. It goes to the front of the cache.
+  *
+  * @retval Device handle, NULL if none could be opened
+  */
+static hid_device *OpenEnumerated (void)
+{
+    struct hid_device_info *devs, *cur, *pick = NULL;
+    hid_device *dev = NULL;
+    int iRank = SEEN_SIZE;
+    int i;
+
+    devs = hid_enumerate(SARK_VID, SARK_PID);
+    for (cur = devs; cur != NULL; cur = cur->next)
+    {
+        if (pick == NULL)
+            pick = cur;
+        for (i = 0; i < iSeenCount && i < iRank && cur->serial_number != NULL; i++)
+        {
+            if (tSeen[i].twszSerial[0] != L'\0' && wcscmp(cur->serial_number, tSeen[i].twszSerial) == 0)
+            {
+                pick = cur;
+                iRank = i;
+                break;
+            }
+        }
+    }
+
+    if (pick != NULL)
+    {
+        dev = hid_open_path(pick->path);
+        if (dev != NULL)
+            Remember(pick->path, pick->serial_number);
+    }
+    hid_free_enumeration(devs);
+    return dev;
+}
+#endif
+
 /**
   * @brief Close connection with the device
   *
@@ -106,8 +253,13 @@ int Sark_Close (void)
 #if defined(_WIN32)
     rawhid_close(0);
 #else
-    // Finalize the hidapi library
-    hid_exit();
+    // The library stays initialised for the life of the process so a
+    // reconnect does not pay for it again
+    if (handle != NULL)
+    {
+        hid_close(handle);
+        handle = NULL;
+    }
 #endif
     return 1;
 }
@@ -678,7 +830,7 @@ int Sark_Buzzer (uint16_t u16Freq, uint16_t u16Duration)
   * @param  None
   * @retval None
   */
-static void Float2Buf (uint8_t tu8Buf[4], float fVal)
+void Float2Buf (uint8_t tu8Buf[4], float fVal)
 {
     uint32_t u32Val = *((uint32_t*)(&fVal));
     Int2Buf(tu8Buf, u32Val);
@@ -689,7 +841,7 @@ static void Float2Buf (uint8_t tu8Buf[4], float fVal)
   * @param  None
   * @retval None
   */
-static void Int2Buf (uint8_t tu8Buf[4], uint32_t u32Val)
+void Int2Buf (uint8_t tu8Buf[4], uint32_t u32Val)
 {
     tu8Buf[3] = (uint8_t)((u32Val&0xff000000)>>24);
     tu8Buf[2] = (uint8_t)((u32Val&0x00ff0000)>>16);
@@ -702,7 +854,7 @@ static void Int2Buf (uint8_t tu8Buf[4], uint32_t u32Val)
   * @param  None
   * @retval None
   */
-static void Buf2Float (float *pfVal, uint8_t tu8Buf[4])
+void Buf2Float (float *pfVal, uint8_t tu8Buf[4])
 {
     uint32_t u32Val;
     Buf2Int(&u32Val, tu8Buf);
@@ -714,7 +866,7 @@ static void Buf2Float (float *pfVal, uint8_t tu8Buf[4])
   * @param  None
   * @retval None
   */
-static void Buf2Int (uint32_t *pu32Val, uint8_t tu8Buf[4])
+void Buf2Int (uint32_t *pu32Val, uint8_t tu8Buf[4])
 {
     uint32_t u32Val;
 
@@ -788,7 +940,7 @@ union Bits
 static int32_t const C_MAXD = C_INFC - C_MAXC - 1;
 static int32_t const C_MIND = C_MINC - C_SUBC - 1;
 
-static uint16_t Float2Half(float value)
+uint16_t Float2Half(float value)
 {
     union Bits v, s;
     v.f = value;
@@ -806,7 +958,7 @@ static uint16_t Float2Half(float value)
     return v.ui | sign;
 }
 
-static float Half2Float(uint16_t value)
+float Half2Float(uint16_t value)
 {
     union Bits v;
     v.ui = value;
@@ -69,6 +69,14 @@ extern int Sark_DiskVolume (uint8_t *pu8Volume);
 extern int Sark_Buzzer (uint16_t u16Freq, uint16_t u16Duration);
 extern int Sark_Device_Reset (int16_t num);
 
+/* Frame field encoders / decoders, exported for the benchmarks */
+extern void Float2Buf (uint8_t tu8Buf[4], float fVal);
+extern void Int2Buf (uint8_t tu8Buf[4], uint32_t u32Val);
+extern void Buf2Int (uint32_t *pu32Val, uint8_t tu8Buf[4]);
+extern void Buf2Float (float *pfVal, uint8_t tu8Buf[4]);
+extern uint16_t Float2Half(float value);
+extern float Half2Float(uint16_t value);
+
 #endif	 /* __SARK_CLIENT_H__ */
 
 /**
@@ -21,7 +21,9 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include <math.h>
 #include <stdlib.h>
 
-#include "config.h"
+#include <algorithm>
+#include <complex>
+
 
 #include "eventreceiver.h"
 #include "scandata.h"
@@ -32,10 +34,25 @@ Sample::Sample()
     swr = 1.0;
     Z = R = 50.0;
     X = 0.0;
+    s21re = s21im = 0.0;
+    suspect = false;
+}
+
+double Sample::S21dB() const
+{
+    double mag = std::abs(std::complex<double>(s21re, s21im));
+    return mag>1e-10 ? 20.0*log10(mag) : -200.0;
+}
+
+double Sample::S21deg() const
+{
+    return atan2(s21im, s21re)*180.0/3.14159265358979323846;
 }
 
 ScanData::ScanData()
 {
+  swr_bw_max = 1.5;
+  thru = false;
   //points = NULL;
   //SetPointCount(101);
 }
@@ -64,8 +81,16 @@ void ScanData::UpdateStats()
     freq_start = points.front().freq;
     freq_end = points.back().freq;
 
-    for (unsigned int i=0;i<points.size();i++)
+    //Points flagged as glitches do not get to set the extremes, unless all are flagged
+    unsigned int first = 0;
+    while (first<points.size()-1 && points[first].suspect)
+        first++;
+    swr_min_idx = Z_min_idx = X_min_idx = R_min_idx = Z_max_idx = X_max_idx = R_max_idx = swr_max_idx = first;
+
+    for (unsigned int i=first;i<points.size();i++)
     {
+        if (points[i].suspect)
+            continue;
         //double
            //n = points[i].Z*points[i].Z - points[i].R*points[i].R;
 
@@ -80,15 +105,37 @@ void ScanData::UpdateStats()
         if (points[i].R < points[R_min_idx].R) { R_min_idx=i; }
         if (points[i].R > points[R_max_idx].R) { R_max_idx=i; }
     }
-    for (int i=swr_bw_lo_idx=swr_min_idx;i>=0 && i<(int)points.size() && points[i].swr<=Config::swr_bw_max;i--)
-        swr_bw_lo_idx=i;
-    for (int i=swr_bw_hi_idx=swr_min_idx;i<(int)points.size() && points[i].swr<=Config::swr_bw_max;i++)
-        swr_bw_hi_idx=i;
+    //A glitch inside the band neither ends it nor becomes its edge
+    for (int i=swr_bw_lo_idx=swr_min_idx;i>=0 && (points[i].suspect || points[i].swr<=swr_bw_max);i--)
+        if (!points[i].suspect)
+            swr_bw_lo_idx=i;
+    for (int i=swr_bw_hi_idx=swr_min_idx;i<(int)points.size() && (points[i].suspect || points[i].swr<=swr_bw_max);i++)
+        if (!points[i].suspect)
+            swr_bw_hi_idx=i;
 
 
 //fflush(stdout);
 }
 
+// Exchanges the contents of two scans, the points are not copied
+void ScanData::Swap(ScanData &other)
+{
+    points.swap(other.points);
+    std::swap(freq_start,other.freq_start);
+    std::swap(freq_end,other.freq_end);
+    std::swap(swr_min_idx,other.swr_min_idx);
+    std::swap(swr_max_idx,other.swr_max_idx);
+    std::swap(Z_min_idx,other.Z_min_idx);
+    std::swap(Z_max_idx,other.Z_max_idx);
+    std::swap(X_min_idx,other.X_min_idx);
+    std::swap(X_max_idx,other.X_max_idx);
+    std::swap(R_min_idx,other.R_min_idx);
+    std::swap(R_max_idx,other.R_max_idx);
+    std::swap(swr_bw_lo_idx,other.swr_bw_lo_idx);
+    std::swap(swr_bw_hi_idx,other.swr_bw_hi_idx);
+    std::swap(thru,other.thru);
+}
+
 void ScanData::dummy_data(EventReceiver *erx)
 {
     //freq_start = 26205000.0;
@@ -115,6 +162,8 @@ void ScanData::toDom(QDomDocument &doc,QDomElement &parent)
 
     element.setAttribute(QString("fstart"),freq_start);
     element.setAttribute(QString("fend"),freq_end);
+    if (thru)
+        element.setAttribute(QString("thru"),1);
 
     //version.toDom(doc,ca);
 
@@ -129,6 +178,13 @@ void ScanData::toDom(QDomDocument &doc,QDomElement &parent)
         toDom_Text(doc,point,"Z",points[i].Z);
         toDom_Text(doc,point,"X",points[i].X);
         toDom_Text(doc,point,"R",points[i].R);
+        if (points[i].suspect)
+            point.setAttribute(QString("suspect"),1);
+        if (thru)
+        {
+            toDom_Text(doc,point,"S21re",points[i].s21re);
+            toDom_Text(doc,point,"S21im",points[i].s21im);
+        }
         element.appendChild(point);
     }
 
@@ -142,6 +198,7 @@ bool ScanData::fromDom(QDomElement &e0)
 
     freq_start = e0.attribute("fstart", "0").toDouble();
     freq_end = e0.attribute("fend", "0").toDouble();
+    thru = e0.attribute("thru", "0").toInt()!=0;
 
     points.clear();
 
@@ -153,6 +210,7 @@ bool ScanData::fromDom(QDomElement &e0)
         if (e1.tagName() == "point")
         {
             point.freq = e1.attribute("freq", "0").toDouble();
+            point.suspect = e1.attribute("suspect", "0").toInt()!=0;
 
             for (QDomNode n2 = e1.firstChild(); !n2.isNull(); n2 = n2.nextSibling())
             {
@@ -163,6 +221,8 @@ bool ScanData::fromDom(QDomElement &e0)
                 else if (e2.tagName() == "Z")	{ point.Z = e2.text().toDouble(); }
                 else if (e2.tagName() == "X")	{ point.X = e2.text().toDouble(); }
                 else if (e2.tagName() == "R")	{ point.R = e2.text().toDouble(); }
+                else if (e2.tagName() == "S21re")	{ point.s21re = e2.text().toDouble(); }
+                else if (e2.tagName() == "S21im")	{ point.s21im = e2.text().toDouble(); }
             }
 
             points.push_back(point);
@@ -174,6 +234,68 @@ bool ScanData::fromDom(QDomElement &e0)
     return true;
 }
 
+void ScanData::toCsv(QTextStream &ts, char sep)
+{
+    ts << "freq" << sep << "SWR" << sep << "Z" << sep << "R" << sep << "X";
+    if (thru)
+        ts << sep << "S21dB" << sep << "S21deg";
+    ts << "\n";
+
+    for (unsigned int i=0;i<points.size();i++)
+    {
+        ts << QString("%1%6%2%6%3%6%4%6%5")
+              .arg(points[i].freq/1000000.0,0,'f')
+              .arg(points[i].swr)
+              .arg(points[i].Z)
+              .arg(points[i].R)
+              .arg(points[i].X)
+              .arg(sep);
+        if (thru)
+            ts << sep << points[i].S21dB() << sep << points[i].S21deg();
+        ts << "\n";
+    }
+}
+
+// One-port Touchstone (.s1p), S11 as real/imaginary referred to 50 ohm
+void ScanData::toTouchstone(QTextStream &ts)
+{
+    ts << "! " << points.size() << " points\n";
+    ts << "# Hz S RI R 50\n";
+
+    for (unsigned int i=0;i<points.size();i++)
+    {
+        std::complex<double> z(points[i].R,points[i].X);
+        std::complex<double> rho = (z-50.0)/(z+50.0);
+
+        ts << QString("%1 %2 %3\n")
+              .arg(points[i].freq,0,'f',0)
+              .arg(rho.real(),0,'g',9)
+              .arg(rho.imag(),0,'g',9);
+    }
+}
+
+// Two-port Touchstone (.s2p) from a thru sweep. Only the forward direction is
+// measured, S12 and S22 are written as 0 as other one-path analyzers do.
+void ScanData::toTouchstone2(QTextStream &ts)
+{
+    ts << "! " << points.size() << " points\n";
+    ts << "! S12 and S22 were not measured, they are written as 0\n";
+    ts << "# Hz S RI R 50\n";
+
+    for (unsigned int i=0;i<points.size();i++)
+    {
+        std::complex<double> z(points[i].R,points[i].X);
+        std::complex<double> rho = (z-50.0)/(z+50.0);
+
+        ts << QString("%1 %2 %3 %4 %5 0 0 0 0\n")
+              .arg(points[i].freq,0,'f',0)
+              .arg(rho.real(),0,'g',9)
+              .arg(rho.imag(),0,'g',9)
+              .arg(points[i].s21re,0,'g',9)
+              .arg(points[i].s21im,0,'g',9);
+    }
+}
+
 void Sample::fromRaw(double vf,double vr,double vz,double va)
 {
     swr = (vf + vr) / (vf - vr);
@@ -181,3 +303,18 @@ void Sample::fromRaw(double vf,double vr,double vz,double va)
     R = ((2500.0 + Z*Z) * swr)/(50.0 * (swr*swr + 1));
     X = Z>R ? sqrt(Z*Z - R*R) : -sqrt(-Z*Z + R*R);
 }
+
+// From the complex impedance the device reports, SWR against 50 ohms
+void Sample::fromZ(double f,double r,double x)
+{
+    std::complex<double> cxZ(r, x);
+    std::complex<double> cxRho = (cxZ - 50.0) / (cxZ + 50.0);
+    if (std::abs(cxRho) > 0.980197824)
+        swr = 99.999;
+    else
+        swr = (1.0 + std::abs(cxRho)) / (1.0 - std::abs(cxRho));
+    R = r;
+    X = x;
+    Z = std::abs(cxZ);
+    freq = f;
+}
@@ -32,8 +32,13 @@ class Sample
 public:
     Sample();
     void fromRaw(double vf,double vr,double vz,double va);
+    void fromZ(double f,double r,double x);
+    double S21dB() const;
+    double S21deg() const;
 
     double freq, swr, R, Z, X;
+    double s21re, s21im;    //Transmission, only measured in thru sweeps
+    bool suspect;           //Failed the glitch test and was not confirmed, left out of the stats
 };
 
 class ScanData
@@ -43,9 +48,13 @@ public:
     void SetPointCount(int n);
     int GetPointCount();
     void UpdateStats();
+    void Swap(ScanData &other);
     void dummy_data(EventReceiver *);
     void toDom(QDomDocument &doc,QDomElement &parent);
     bool fromDom(QDomElement &e0);
+    void toCsv(QTextStream &ts, char sep = ',');
+    void toTouchstone(QTextStream &ts);
+    void toTouchstone2(QTextStream &ts);
 
     std::vector<Sample> points;
     //int point_count;
@@ -54,6 +63,8 @@ public:
     double freq_start,freq_end;
     int swr_min_idx, swr_max_idx, Z_min_idx, Z_max_idx, X_min_idx, X_max_idx, R_min_idx, R_max_idx;
     int swr_bw_lo_idx,swr_bw_hi_idx;
+    double swr_bw_max;      //SWR limit of the bandwidth stats, set by the owner of the scan
+    bool thru;              //Points carry S21 from a two-port sweep
 };
 
 #endif // SCANDATA_H
@@ -0,0 +1,104 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scandatamodel.h"
+
+ScanDataModel::ScanDataModel(ScanData *data, QObject *parent) :
+    QAbstractTableModel(parent)
+{
+    scan = data;
+    rows = scan->points.size();
+}
+
+int ScanDataModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int ScanDataModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : (scan->thru ? 7 : 5);
+}
+
+QVariant ScanDataModel::data(const QModelIndex &index, int role) const
+{
+    if (role!=Qt::DisplayRole || !index.isValid() || index.row()>=rows)
+        return QVariant();
+
+    //Cells are only formatted when a view asks for them, i.e. for the visible rows
+    const Sample *point = &scan->points[index.row()];
+
+    switch (index.column())
+    {
+      case 0: return QString("%1").arg(point->freq/1000000.0,0,'f');
+      case 1: return QString("%1").arg(point->swr);
+      case 2: return QString("%1").arg(point->Z);
+      case 3: return QString("%1").arg(point->R);
+      case 4: return QString("%1").arg(point->X);
+      case 5: return QString("%1").arg(point->S21dB(),0,'f',2);
+      case 6: return QString("%1").arg(point->S21deg(),0,'f',1);
+    }
+    return QVariant();
+}
+
+QVariant ScanDataModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *labels[] = {"freq","SWR","Z","R","X","S21 dB","S21 deg"};
+
+    if (role!=Qt::DisplayRole)
+        return QVariant();
+    if (orientation==Qt::Horizontal)
+        return section<7 ? QString(labels[section]) : QVariant();
+    return section+1;
+}
+
+// Drops all rows, call before the scan data is cleared
+void ScanDataModel::Clear()
+{
+    beginResetModel();
+    rows = 0;
+    endResetModel();
+}
+
+// All the points may have changed, e.g. after swapping scan buffers
+void ScanDataModel::Reload()
+{
+    beginResetModel();
+    rows = scan->points.size();
+    endResetModel();
+}
+
+// Announces the points added to the scan since the last call
+void ScanDataModel::Update()
+{
+    int n = scan->points.size();
+
+    if (n<rows)
+    {
+        beginResetModel();
+        rows = n;
+        endResetModel();
+    }
+    else if (n>rows)
+    {
+        beginInsertRows(QModelIndex(),rows,n-1);
+        rows = n;
+        endInsertRows();
+    }
+}
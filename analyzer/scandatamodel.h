@@ -0,0 +1,47 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANDATAMODEL_H
+#define SCANDATAMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "scandata.h"
+
+class ScanDataModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ScanDataModel(ScanData *data, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    void Clear();
+    void Update();
+    void Reload();
+
+private:
+    ScanData *scan;
+    int rows;   //Rows announced to the views, may lag behind the scan while it is filled
+};
+
+#endif // SCANDATAMODEL_H
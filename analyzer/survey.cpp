@@ -0,0 +1,118 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "bands.h"
+#include "survey.h"
+
+static bool segment_before(const SweepSegment &a, const SweepSegment &b)
+{
+    return a.freq_start < b.freq_start;
+}
+
+BandSurvey::BandSurvey(DeviceIO *device) : runner(device)
+{
+}
+
+// One segment of points per band, so each band's step follows its own width and
+// the whole survey stays a quick overview however wide the presets are. Segments
+// run in ascending frequency to keep synthesiser retuning short.
+void BandSurvey::BuildPlan(int points)
+{
+    plan.segments.clear();
+
+    for (int i=0;i<Bands::count;i++)
+    {
+        if (!Bands::table[i].survey)
+            continue;
+
+        SweepSegment seg;
+        seg.name = Bands::table[i].name;
+        seg.freq_start = (Bands::table[i].centre-Bands::table[i].span/2.0)*1000000;
+        seg.freq_end = (Bands::table[i].centre+Bands::table[i].span/2.0)*1000000;
+        seg.points = points;
+        plan.segments.push_back(seg);
+    }
+    std::stable_sort(plan.segments.begin(),plan.segments.end(),segment_before);
+}
+
+bool BandSurvey::Run(EventReceiver *erx)
+{
+    bool ok = runner.Run(plan, erx);
+
+    summary.clear();
+    for (unsigned int i=0;i<runner.results.size();i++)
+    {
+        ScanData &scan = runner.results[i].scan;
+        BandSummary s;
+
+        if (scan.points.empty())
+            continue;
+
+        s.name = plan.segments[runner.results[i].segment].name;
+        s.freq_start = scan.freq_start;
+        s.freq_end = scan.freq_end;
+        s.swr_min = scan.points[scan.swr_min_idx].swr;
+        s.f_res = scan.points[scan.swr_min_idx].freq;
+        s.Z_res = scan.points[scan.swr_min_idx].Z;
+        s.points = scan.points.size();
+        s.result = i;
+        if (s.swr_min <= runner.swr_bw_max)
+        {
+            s.bw_lo = scan.points[scan.swr_bw_lo_idx].freq;
+            s.bw_hi = scan.points[scan.swr_bw_hi_idx].freq;
+        }
+        else
+            s.bw_lo = s.bw_hi = 0;
+        summary.push_back(s);
+    }
+    return ok;
+}
+
+// Index in runner.results of the band with the lowest SWR, -1 if none
+int BandSurvey::Best()
+{
+    int best = -1;
+
+    for (unsigned int i=0;i<runner.results.size();i++)
+    {
+        ScanData &scan = runner.results[i].scan;
+        if (scan.points.empty())
+            continue;
+        if (best<0 || scan.points[scan.swr_min_idx].swr < runner.results[best].scan.points[runner.results[best].scan.swr_min_idx].swr)
+            best = i;
+    }
+    return best;
+}
+
+QString BandSurvey::Report()
+{
+    QString txt("band\tpoints\tSWR min\tf (MHz)\tZ\tbw (MHz)\n");
+
+    for (unsigned int i=0;i<summary.size();i++)
+        txt += QString("%1\t%2\t%3\t%4\t%5\t%6\n")
+                .arg(summary[i].name)
+                .arg(summary[i].points)
+                .arg(summary[i].swr_min,0,'f',2)
+                .arg(summary[i].f_res/1000000.0,0,'f',4)
+                .arg(summary[i].Z_res,0,'f',1)
+                .arg((summary[i].bw_hi-summary[i].bw_lo)/1000000.0,0,'f',3);
+    return txt;
+}
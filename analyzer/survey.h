@@ -0,0 +1,55 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SURVEY_H
+#define SURVEY_H
+
+#include <vector>
+
+#include <QString>
+
+#include "sweepplan.h"
+
+class BandSummary
+{
+public:
+    QString name;
+    double freq_start, freq_end;
+    double swr_min, f_res, Z_res;   //Best match in the band
+    double bw_lo, bw_hi;            //Range below runner.swr_bw_max around it, 0 if none
+    int points;                     //Swept in the band
+    int result;                     //Index of the sweep in runner.results
+};
+
+// Sweeps all the survey band presets as a single back-to-back job
+class BandSurvey
+{
+public:
+    BandSurvey(DeviceIO *device);
+    void BuildPlan(int points);
+    bool Run(EventReceiver *erx);
+    int Best();
+    QString Report();
+
+    SweepPlan plan;
+    PlanRunner runner;
+    std::vector<BandSummary> summary;
+};
+
+#endif // SURVEY_H
@@ -0,0 +1,187 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <complex>
+
+#include "sweepavg.h"
+
+SweepAverager::SweepAverager()
+{
+    mode = mode_off;
+    sweeps = 8;
+    n = 0;
+    count = ring_pos = 0;
+    freq_start = freq_end = 0;
+}
+
+void SweepAverager::SetMode(mode_t m, int s)
+{
+    if (m==mode && s==sweeps)
+        return;
+    mode = m;
+    sweeps = s<1 ? 1 : s;
+    Reset();
+}
+
+// Drops the aggregates, the next sweep starts them again
+void SweepAverager::Reset()
+{
+    n = 0;
+    count = 0;
+    average.points.clear();
+    swr_max.clear();
+    swr_min.clear();
+}
+
+// Sweeps folded into the aggregates so far
+int SweepAverager::Count()
+{
+    return count;
+}
+
+void SweepAverager::Restart(const ScanData &scan)
+{
+    n = scan.points.size();
+    freq_start = scan.freq_start;
+    freq_end = scan.freq_end;
+    count = ring_pos = 0;
+
+    gre.assign(n, 0.0);
+    gim.assign(n, 0.0);
+    are.assign(n, 0.0);
+    aim.assign(n, 0.0);
+    ring.assign(mode==mode_boxcar ? 2*n*sweeps : 0, 0.0);
+    swr_max.assign(n, 0.0);
+    swr_min.assign(n, 0.0);
+    held.assign(n, 0);
+}
+
+// Folds a sweep in, a sweep on another grid starts everything again
+void SweepAverager::Add(const ScanData &scan)
+{
+    if (scan.points.size()!=n || scan.freq_start!=freq_start || scan.freq_end!=freq_end || n==0)
+        Restart(scan);
+    if (n==0)
+        return;
+
+    const Sample *p = &scan.points[0];
+    double *mx = &swr_max[0], *mn = &swr_min[0];
+    char *h = &held[0];
+    for (unsigned int i=0; i<n; i++)
+    {
+        double swr = p[i].swr;
+        if (!h[i])
+        {
+            //Shows the latest reading until one that is not a glitch starts the holds
+            mx[i] = mn[i] = swr;
+            h[i] = !p[i].suspect;
+        }
+        else if (!p[i].suspect)
+        {
+            mx[i] = swr>mx[i] ? swr : mx[i];
+            mn[i] = swr<mn[i] ? swr : mn[i];
+        }
+    }
+    count++;
+
+    if (mode==mode_off)
+        return;
+
+    //Reflection is linear in the measured vectors, so it is what gets averaged
+    double *xr = &gre[0], *xi = &gim[0], *ar = &are[0], *ai = &aim[0];
+    for (unsigned int i=0; i<n; i++)
+    {
+        std::complex<double> z(p[i].R, p[i].X);
+        std::complex<double> g = (z-50.0)/(z+50.0);
+        xr[i] = g.real();
+        xi[i] = g.imag();
+    }
+
+    //A suspect point counts as the bin's previous average, the first sweep has none yet
+    if (count>1)
+    {
+        double prev = mode==mode_ema ? 1.0 : 1.0/(count-1<sweeps ? count-1 : sweeps);
+        for (unsigned int i=0; i<n; i++)
+        {
+            if (p[i].suspect)
+            {
+                xr[i] = ar[i]*prev;
+                xi[i] = ai[i]*prev;
+            }
+        }
+    }
+
+    double scale;
+    if (mode==mode_ema)
+    {
+        //The first sweeps are weighted 1/count so the average does not start from zero
+        double alpha = 2.0/(sweeps+1);
+        if (alpha < 1.0/count)
+            alpha = 1.0/count;
+        for (unsigned int i=0; i<n; i++)
+        {
+            ar[i] += alpha*(xr[i]-ar[i]);
+            ai[i] += alpha*(xi[i]-ai[i]);
+        }
+        scale = 1.0;
+    }
+    else
+    {
+        double *or_ = &ring[2*n*ring_pos], *oi = or_ + n;
+        for (unsigned int i=0; i<n; i++)
+        {
+            ar[i] += xr[i] - or_[i];
+            ai[i] += xi[i] - oi[i];
+            or_[i] = xr[i];
+            oi[i] = xi[i];
+        }
+        ring_pos = (ring_pos+1) % sweeps;
+
+        //Sums are rebuilt from the ring once per lap so rounding does not accumulate
+        if (ring_pos==0)
+        {
+            are.assign(n, 0.0);
+            aim.assign(n, 0.0);
+            ar = &are[0];
+            ai = &aim[0];
+            for (int s=0; s<sweeps; s++)
+            {
+                const double *sr = &ring[2*n*s], *si = sr + n;
+                for (unsigned int i=0; i<n; i++)
+                {
+                    ar[i] += sr[i];
+                    ai[i] += si[i];
+                }
+            }
+        }
+        scale = 1.0/(count<sweeps ? count : sweeps);
+    }
+
+    average.swr_bw_max = scan.swr_bw_max;
+    average.freq_start = scan.freq_start;
+    average.freq_end = scan.freq_end;
+    average.points.resize(n);
+    for (unsigned int i=0; i<n; i++)
+    {
+        std::complex<double> g(ar[i]*scale, ai[i]*scale);
+        std::complex<double> z = 50.0*(1.0+g)/(1.0-g);
+        average.points[i].fromZ(p[i].freq, z.real(), z.imag());
+    }
+    average.UpdateStats();
+}
@@ -0,0 +1,61 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWEEPAVG_H
+#define SWEEPAVG_H
+
+#include <vector>
+
+#include "scandata.h"
+
+// Running aggregates over repeated sweeps of the same grid: exponential or
+// boxcar average of the reflection, and per point SWR max and min hold.
+// Suspect points are left out: the average takes the bin's previous average
+// in their place, and a hold starts at the bin's first reading that is not suspect.
+// State is kept as plain arrays per quantity so the per sweep loops are
+// simple element-wise passes the compiler can vectorise.
+class SweepAverager
+{
+public:
+    enum mode_t {mode_off, mode_ema, mode_boxcar};
+
+    SweepAverager();
+    void SetMode(mode_t m, int n);
+    void Reset();
+    void Add(const ScanData &scan);
+    int Count();
+
+    mode_t mode;
+    int sweeps;                 //Boxcar length, or EMA time constant in sweeps
+    ScanData average;           //Aggregate of the sweeps so far, empty when mode_off
+    std::vector<double> swr_max, swr_min;
+
+private:
+    void Restart(const ScanData &scan);
+
+    std::vector<double> gre, gim;   //Reflection of the sweep being added
+    std::vector<double> are, aim;   //EMA state, or boxcar sums
+    std::vector<double> ring;       //Boxcar: the last sweeps, real parts then imaginary
+    std::vector<char> held;         //The holds of a bin have had a reading that is not suspect
+    int count, ring_pos;
+    unsigned int n;
+    double freq_start, freq_end;
+};
+
+#endif // SWEEPAVG_H
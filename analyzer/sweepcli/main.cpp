@@ -0,0 +1,244 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include "config.h"
+#include "scandata.h"
+#include "deviceio.h"
+#include "sweepplan.h"
+
+class Progress : public EventReceiver
+{
+public:
+    Progress(bool show) { this->show = show; last = -1; }
+
+    void RaiseEvent(event_t event, int arg)
+    {
+        if (event==progress_event && show && arg!=last)
+        {
+            fprintf(stderr, "\r%3d%%", arg);
+            last = arg;
+        }
+    }
+
+private:
+    bool show;
+    int last;
+};
+
+static int run_plan(const QString &filename, bool show_progress, bool show_stats)
+{
+    SweepPlan plan;
+    QString error;
+
+    if (!plan.Load(filename, error))
+    {
+        fprintf(stderr, "%s\n", error.toLocal8Bit().data());
+        return 1;
+    }
+
+    Config::read();
+
+    QElapsedTimer timer;
+    qint64 t_connect, t_sweep;
+
+    timer.start();
+    DeviceIO device;
+    t_connect = timer.restart();
+    if (!device.IsUp())
+    {
+        fprintf(stderr, "SARK-110 not found\n");
+        return 2;
+    }
+
+    Progress progress(show_progress);
+    PlanRunner runner(&device);
+    runner.swr_bw_max = Config::swr_bw_max;
+
+    bool ok = runner.Run(plan, &progress);
+    t_sweep = timer.elapsed();
+    if (show_progress)
+        fprintf(stderr, "\n");
+    if (!ok)
+    {
+        fprintf(stderr, "Device lost during the plan\n");
+        return 3;
+    }
+    if (!runner.WriteOutputs(plan, error))
+    {
+        fprintf(stderr, "%s\n", error.toLocal8Bit().data());
+        return 1;
+    }
+
+    if (show_stats)
+    {
+        int points = 0;
+        for (unsigned int i=0;i<runner.results.size();i++)
+            points += runner.results[i].scan.points.size();
+        fprintf(stderr, "connect %lld ms, plan %lld ms, %d sweeps, %d points, %.1f points/s\n",
+                (long long)t_connect, (long long)t_sweep, (int)runner.results.size(), points,
+                t_sweep ? points*1000.0/t_sweep : 0.0);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("analyzer-sweep");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("One-shot SARK-110 sweep");
+    parser.addHelpOption();
+
+    QCommandLineOption startOpt(QStringList() << "s" << "start", "Start frequency in MHz.", "MHz");
+    QCommandLineOption stopOpt(QStringList() << "e" << "stop", "Stop frequency in MHz.", "MHz");
+    QCommandLineOption pointsOpt(QStringList() << "n" << "points", "Number of steps (default 100).", "n", "100");
+    QCommandLineOption avgOpt(QStringList() << "a" << "avg", "Readings averaged per point (default 1).", "n", "1");
+    QCommandLineOption adaptOpt(QStringList() << "adapt", "Average up to --avg readings only at noisy points.");
+    QCommandLineOption deglitchOpt(QStringList() << "deglitch", "Measure points that jump away from the sweep again.");
+    QCommandLineOption formatOpt(QStringList() << "f" << "format", "Output format: csv, s1p, s2p or xml (default csv). s2p sweeps through port 2.", "format", "csv");
+    QCommandLineOption outputOpt(QStringList() << "o" << "output", "Output file (default stdout).", "file");
+    QCommandLineOption progressOpt(QStringList() << "p" << "progress", "Show progress on stderr.");
+    QCommandLineOption statsOpt(QStringList() << "t" << "timing", "Print timing stats on stderr.");
+    QCommandLineOption planOpt(QStringList() << "plan", "Run the sweep plan file, outputs go where the plan says.", "file");
+
+    parser.addOption(startOpt);
+    parser.addOption(stopOpt);
+    parser.addOption(pointsOpt);
+    parser.addOption(avgOpt);
+    parser.addOption(adaptOpt);
+    parser.addOption(deglitchOpt);
+    parser.addOption(formatOpt);
+    parser.addOption(outputOpt);
+    parser.addOption(progressOpt);
+    parser.addOption(statsOpt);
+    parser.addOption(planOpt);
+    parser.process(a);
+
+    if (parser.isSet(planOpt))
+        return run_plan(parser.value(planOpt), parser.isSet(progressOpt), parser.isSet(statsOpt));
+
+    double fstart = parser.value(startOpt).toDouble()*1000000;
+    double fend = parser.value(stopOpt).toDouble()*1000000;
+    int points = parser.value(pointsOpt).toInt();
+    QString format = parser.value(formatOpt);
+
+    if (fstart<FMIN || fend>FMAX || fend<=fstart || points<1)
+    {
+        fprintf(stderr, "Bad sweep range, use --start and --stop in MHz and --points > 0\n");
+        return 1;
+    }
+    if ((fend-fstart)/points < 1)
+    {
+        fprintf(stderr, "Too many points, the step must be at least 1 Hz\n");
+        return 1;
+    }
+    if (format!="csv" && format!="s1p" && format!="s2p" && format!="xml")
+    {
+        fprintf(stderr, "Unknown format %s\n", format.toLocal8Bit().data());
+        return 1;
+    }
+
+    Config::read();
+
+    QElapsedTimer timer;
+    qint64 t_connect, t_sweep;
+
+    timer.start();
+    DeviceIO device;
+    t_connect = timer.restart();
+    if (!device.IsUp())
+    {
+        fprintf(stderr, "SARK-110 not found\n");
+        return 2;
+    }
+    if (parser.isSet(adaptOpt))
+        device.SetAdaptive(parser.value(avgOpt).toInt(), Config::adapt_tol);
+    else
+        device.SetSamples(parser.value(avgOpt).toInt());
+    device.SetThru(format=="s2p");
+    device.SetDeglitch(parser.isSet(deglitchOpt));
+
+    ScanData scan;
+    Progress progress(parser.isSet(progressOpt));
+
+    scan.swr_bw_max = Config::swr_bw_max;
+    scan.freq_start = fstart;
+    scan.freq_end = fend;
+    scan.SetPointCount(points);
+
+    timer.restart();
+    device.Cmd_Scan(scan, (long)fstart, (long)fend, (long)((fend-fstart)/points), &progress);
+    t_sweep = timer.elapsed();
+    if (parser.isSet(progressOpt))
+        fprintf(stderr, "\n");
+    if (!device.IsUp())
+    {
+        fprintf(stderr, "Device lost during the sweep\n");
+        return 3;
+    }
+    device.Cmd_Off();
+
+    QFile file;
+    if (parser.isSet(outputOpt))
+    {
+        file.setFileName(parser.value(outputOpt));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            fprintf(stderr, "Cannot write %s\n", file.fileName().toLocal8Bit().data());
+            return 1;
+        }
+    }
+    else
+        file.open(stdout, QIODevice::WriteOnly);
+
+    QTextStream ts(&file);
+    if (format=="csv")
+        scan.toCsv(ts);
+    else if (format=="s1p")
+        scan.toTouchstone(ts);
+    else if (format=="s2p")
+        scan.toTouchstone2(ts);
+    else
+    {
+        QDomDocument doc("AnalyzerML");
+        QDomElement element = doc.createElement("analyzer");
+        scan.toDom(doc,element);
+        doc.appendChild(element);
+        ts.setCodec(Config::DOM_ENCODING);
+        ts << doc.toString();
+    }
+    ts.flush();
+    file.close();
+
+    if (parser.isSet(statsOpt))
+        fprintf(stderr, "connect %lld ms, sweep %lld ms, %d points, %.1f points/s\n",
+                (long long)t_connect, (long long)t_sweep, (int)scan.points.size(),
+                t_sweep ? scan.points.size()*1000.0/t_sweep : 0.0);
+
+    return 0;
+}
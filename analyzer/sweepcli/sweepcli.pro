@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Command line one-shot sweep, no GUI
+#
+#-------------------------------------------------
+
+QT       += xml core
+QT       -= gui
+
+TARGET = analyzer-sweep
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+    ../config.cpp
+
+HEADERS  += ../config.h
+
+include(../core/core.pri)
@@ -0,0 +1,231 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QCoreApplication>
+
+#include "sweepplan.h"
+
+SweepSegment::SweepSegment()
+{
+    freq_start = freq_end = 0;
+    points = 100;
+    samples = 1;
+    adaptive = false;
+    dwell = 0;
+    repeat = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SweepPlan::Load(const QString &filename, QString &error)
+{
+    QDomDocument doc;
+    QFile file(filename);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        error = QString("Cannot read file %1: %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+    if (!doc.setContent(&file, &error))
+    {
+        file.close();
+        return false;
+    }
+    file.close();
+
+    QDomElement root = doc.documentElement();
+    if (root.tagName() != "sweepplan")
+    {
+        error = "This is not a sweep plan file";
+        return false;
+    }
+    if (!fromDom(root, error))
+        return false;
+
+    //Outputs named relative to the plan land beside it, not in the working directory
+    QDir dir = QFileInfo(filename).dir();
+    for (unsigned int i=0;i<segments.size();i++)
+        if (!segments[i].output.isEmpty() && QFileInfo(segments[i].output).isRelative())
+            segments[i].output = dir.filePath(segments[i].output);
+    return true;
+}
+
+bool SweepPlan::fromDom(QDomElement &e0, QString &error)
+{
+    segments.clear();
+
+    for (QDomNode n1 = e0.firstChild(); !n1.isNull(); n1 = n1.nextSibling())
+    {
+        if (!n1.isElement()) continue;  // Skip any non-element nodes
+
+        QDomElement e1 = n1.toElement();
+        if (e1.tagName() == "segment")
+        {
+            SweepSegment seg;
+
+            seg.name = e1.attribute("name", QString("segment %1").arg(segments.size()+1));
+            seg.freq_start = e1.attribute("start", "0").toDouble()*1000000;
+            seg.freq_end = e1.attribute("stop", "0").toDouble()*1000000;
+            seg.points = e1.attribute("points", "100").toInt();
+            seg.samples = e1.attribute("avg", "1").toInt();
+            seg.adaptive = e1.attribute("adapt", "0").toInt()!=0;
+            seg.dwell = e1.attribute("dwell", "0").toInt();
+            seg.repeat = e1.attribute("repeat", "1").toInt();
+            seg.output = e1.attribute("output");
+
+            if (seg.freq_start<FMIN || seg.freq_end>FMAX || seg.freq_end<=seg.freq_start || seg.points<1 || seg.repeat<1)
+            {
+                error = QString("Bad range in %1").arg(seg.name);
+                return false;
+            }
+            if ((seg.freq_end-seg.freq_start)/seg.points < 1)
+            {
+                error = QString("Step below 1 Hz in %1").arg(seg.name);
+                return false;
+            }
+            segments.push_back(seg);
+        }
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PlanRunner::PlanRunner(DeviceIO *device)
+{
+    deviceIO = device;
+    swr_bw_max = 1.5;
+}
+
+// Sweeps every segment back to back, the generator is only switched off at the end
+// and outputs are left for WriteOutputs so no file I/O happens between segments.
+// The averaging and thru settings of the device are the caller's again afterwards
+bool PlanRunner::Run(SweepPlan &plan, EventReceiver *erx)
+{
+    int total = 0;
+    int samples = deviceIO->Samples();
+    bool thru = deviceIO->Thru();
+    int adapt_max;
+    double adapt_tol;
+
+    deviceIO->Adaptive(adapt_max, adapt_tol);
+
+    for (unsigned int i=0;i<plan.segments.size();i++)
+        total += plan.segments[i].repeat;
+
+    results.clear();
+    results.reserve(total);
+
+    for (unsigned int i=0;i<plan.segments.size() && deviceIO->IsUp();i++)
+    {
+        SweepSegment &seg = plan.segments[i];
+
+        deviceIO->SetSamples(seg.adaptive ? 1 : seg.samples);
+        deviceIO->SetAdaptive(seg.adaptive ? seg.samples : 0, adapt_tol);
+        deviceIO->SetThru(QFileInfo(seg.output).suffix().toLower()=="s2p");
+        if (seg.dwell>0)
+        {
+            Sample sample;
+            QElapsedTimer wait;
+
+            //The window keeps repainting while the generator settles, user input
+            //waits until the plan is done so no command can start in between
+            deviceIO->Cmd_Single((long)seg.freq_start, sample);
+            wait.start();
+            while (wait.elapsed() < seg.dwell)
+            {
+                QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+                QThread::msleep(10);
+            }
+        }
+
+        for (int pass=0; pass<seg.repeat && deviceIO->IsUp(); pass++)
+        {
+            results.push_back(Result());
+            Result &res = results.back();
+
+            res.segment = i;
+            res.pass = pass;
+            res.scan.swr_bw_max = swr_bw_max;
+            res.scan.freq_start = seg.freq_start;
+            res.scan.freq_end = seg.freq_end;
+            res.scan.SetPointCount(seg.points);
+            deviceIO->Cmd_Scan(res.scan, (long)seg.freq_start, (long)seg.freq_end,
+                               (long)((seg.freq_end-seg.freq_start)/seg.points), erx);
+        }
+    }
+    deviceIO->SetSamples(samples);
+    deviceIO->SetAdaptive(adapt_max, adapt_tol);
+    deviceIO->SetThru(thru);
+    if (deviceIO->IsUp())
+        deviceIO->Cmd_Off();
+
+    return deviceIO->IsUp();
+}
+
+bool PlanRunner::WriteOutputs(SweepPlan &plan, QString &error)
+{
+    for (unsigned int i=0;i<results.size();i++)
+    {
+        SweepSegment &seg = plan.segments[results[i].segment];
+        if (seg.output.isEmpty())
+            continue;
+
+        QString filename = seg.output;
+        if (seg.repeat>1)
+        {
+            QFileInfo fi(seg.output);
+            filename = fi.path() + "/" + fi.completeBaseName() + QString("-%1.").arg(results[i].pass+1) + fi.suffix();
+        }
+
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            error = QString("Cannot write file %1: %2").arg(filename).arg(file.errorString());
+            return false;
+        }
+
+        QTextStream ts(&file);
+        QString ext = QFileInfo(filename).suffix().toLower();
+        if (ext=="s1p")
+            results[i].scan.toTouchstone(ts);
+        else if (ext=="s2p")
+            results[i].scan.toTouchstone2(ts);
+        else if (ext=="analyzer" || ext=="xml")
+        {
+            QDomDocument doc("AnalyzerML");
+            QDomElement element = doc.createElement("analyzer");
+            results[i].scan.toDom(doc,element);
+            doc.appendChild(element);
+            ts.setCodec("UTF-8");
+            ts << doc.toString();
+        }
+        else
+            results[i].scan.toCsv(ts);
+        file.close();
+    }
+    return true;
+}
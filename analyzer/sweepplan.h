@@ -0,0 +1,80 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWEEPPLAN_H
+#define SWEEPPLAN_H
+
+#include <vector>
+
+#include <dom.h>
+#include "scandata.h"
+#include "deviceio.h"
+
+class SweepSegment
+{
+public:
+    SweepSegment();
+
+    QString name, output;
+    double freq_start, freq_end;    //Hz
+    int points;     //Steps across the range
+    int samples;    //Readings averaged by the device per point
+    bool adaptive;  //samples is the most readings, taken only where the point is noisy
+    int dwell;      //ms to wait at the start frequency before sweeping
+    int repeat;     //Sweeps of this segment
+};
+
+// List of sweeps to be run back to back, read from an XML file:
+//  <sweepplan>
+//    <segment name="40m" start="7.0" stop="7.3" points="100" avg="1" dwell="0" repeat="1" output="40m.s1p"/>
+//  </sweepplan>
+// Frequencies are in MHz. The output extension selects the format (.csv, .s1p, .s2p, .analyzer),
+// repeated segments get the repeat number appended to the file name. adapt="1" averages
+// up to avg readings per point only where the readings are noisy.
+class SweepPlan
+{
+public:
+    bool Load(const QString &filename, QString &error);
+    bool fromDom(QDomElement &e0, QString &error);
+
+    std::vector<SweepSegment> segments;
+};
+
+class PlanRunner
+{
+public:
+    class Result
+    {
+    public:
+        int segment, pass;
+        ScanData scan;
+    };
+
+    PlanRunner(DeviceIO *device);
+    bool Run(SweepPlan &plan, EventReceiver *erx);
+    bool WriteOutputs(SweepPlan &plan, QString &error);
+
+    std::vector<Result> results;
+    double swr_bw_max;      //Bandwidth SWR limit given to every result
+
+private:
+    DeviceIO *deviceIO;
+};
+
+#endif // SWEEPPLAN_H
@@ -0,0 +1,317 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include <QJsonDocument>
+#include <QCoreApplication>
+
+#include "config.h"
+#include "sweepserver.h"
+
+SweepServer::SweepServer(QObject *parent) :
+    QObject(parent),
+    reader(&queue)
+{
+    busy = false;
+    streamsweep = 0;
+    streamed = 0;
+    scan.swr_bw_max = Config::swr_bw_max;
+    deviceIO = new DeviceIO();
+    deviceIO->SetEventRate(Config::display_rate);
+    deviceIO->SetQueue(&queue);
+
+    connect(&server, SIGNAL(newConnection()), this, SLOT(Slot_newConnection()));
+}
+
+SweepServer::~SweepServer()
+{
+    delete deviceIO;
+}
+
+bool SweepServer::Listen(const QString &name)
+{
+    QLocalSocket probe;
+
+    // Only a socket nobody answers on is stale; never steal a live daemon's
+    probe.connectToServer(name);
+    if (probe.waitForConnected(500))
+    {
+        probe.disconnectFromServer();
+        return false;
+    }
+    QLocalServer::removeServer(name);
+    return server.listen(name);
+}
+
+QString SweepServer::ServerName()
+{
+    return server.fullServerName();
+}
+
+void SweepServer::Slot_newConnection()
+{
+    QLocalSocket *client;
+
+    while ((client = server.nextPendingConnection()) != NULL)
+    {
+        connect(client, SIGNAL(readyRead()), this, SLOT(Slot_readyRead()));
+        connect(client, SIGNAL(disconnected()), client, SLOT(deleteLater()));
+    }
+}
+
+void SweepServer::Slot_readyRead()
+{
+    QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+    if (!client)
+        return;
+
+    while (client->canReadLine())
+    {
+        QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        QJsonParseError err;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+        if (!doc.isObject())
+        {
+            QJsonObject reply;
+            reply["error"] = QString("bad request: %1").arg(err.errorString());
+            Reply(client, reply);
+            continue;
+        }
+
+        Request req;
+        req.client = client;
+        req.args = doc.object();
+        pending.append(req);
+    }
+
+    Process();
+}
+
+// Sweeps pump the event loop, so requests arriving meanwhile are only queued here
+void SweepServer::Process()
+{
+    if (busy)
+        return;
+
+    busy = true;
+    while (!pending.isEmpty())
+    {
+        Request req = pending.takeFirst();
+        if (req.client)
+            Execute(req);
+    }
+    busy = false;
+}
+
+void SweepServer::Execute(Request &req)
+{
+    QString cmd = req.args.value("cmd").toString();
+    QJsonObject reply;
+
+    reply["cmd"] = cmd;
+    if (req.args.contains("id"))
+        reply["id"] = req.args.value("id");
+
+    if (cmd == "info")
+    {
+        reply["app"] = QString(Config::App);
+        reply["connected"] = deviceIO->IsUp();
+    }
+    else if (cmd == "connect")
+    {
+        delete deviceIO;
+        deviceIO = new DeviceIO();
+        deviceIO->SetEventRate(Config::display_rate);
+        deviceIO->SetQueue(&queue);
+        reply["connected"] = deviceIO->IsUp();
+    }
+    else if (!deviceIO->IsUp())
+    {
+        reply["error"] = QString("device not connected");
+    }
+    else if (cmd == "sweep")
+    {
+        double fstart = req.args.value("start").toDouble();
+        double fend = req.args.value("stop").toDouble();
+        int n = req.args.value("points").toInt(100);
+
+        if (fstart<FMIN || fend>FMAX || fend<=fstart || n<1 || n>100000)
+        {
+            reply["error"] = QString("bad sweep range");
+        }
+        else if ((fend-fstart)/n < 1)
+        {
+            reply["error"] = QString("sweep step below 1 Hz");
+        }
+        else
+        {
+            scan.freq_start = fstart;
+            scan.freq_end = fend;
+            scan.SetPointCount(n);
+
+            streaming = req.client;
+            deviceIO->Cmd_Scan(scan, (long)fstart, (long)fend, (long)((fend-fstart)/n), this);
+            streaming = NULL;
+            if (!req.args.value("keep_on").toBool())
+                deviceIO->Cmd_Off();
+
+            reply["done"] = true;
+            reply["points"] = (int)scan.points.size();
+            if (scan.points.size())
+            {
+                reply["swr_min"] = scan.points[scan.swr_min_idx].swr;
+                reply["f_swr_min"] = scan.points[scan.swr_min_idx].freq;
+                reply["bw"] = scan.points[scan.swr_bw_hi_idx].freq-scan.points[scan.swr_bw_lo_idx].freq;
+            }
+        }
+    }
+    else if (cmd == "single")
+    {
+        long freq = (long)req.args.value("freq").toDouble();
+
+        if (freq<FMIN || freq>FMAX)
+        {
+            reply["error"] = QString("bad frequency");
+        }
+        else
+        {
+            Sample sample;
+            if (deviceIO->Cmd_Single(freq, sample) < 0)
+                reply["error"] = QString("measurement failed");
+            else
+                reply["point"] = PointJson(sample, deviceIO->Thru());
+        }
+    }
+    else if (cmd == "monitor")
+    {
+        long freq = (long)req.args.value("freq").toDouble();
+        int n = req.args.value("count").toInt(10);
+
+        if (freq<FMIN || freq>FMAX)
+        {
+            reply["error"] = QString("bad frequency");
+        }
+        else
+        {
+            for (int i=0; i<n && req.client && deviceIO->IsUp(); i++)
+            {
+                Sample sample;
+                if (deviceIO->Cmd_Single(freq, sample) < 0)
+                    break;
+
+                QJsonObject obj = PointJson(sample, deviceIO->Thru());
+                obj["i"] = i;
+                Reply(req.client, obj);
+                QCoreApplication::processEvents();
+            }
+            deviceIO->Cmd_Off();
+            reply["done"] = true;
+        }
+    }
+    else if (cmd == "off")
+    {
+        deviceIO->Cmd_Off();
+    }
+    else
+    {
+        reply["error"] = QString("unknown command");
+    }
+
+    if (!deviceIO->IsUp())
+        reply["connected"] = false;
+    if (req.client)
+        Reply(req.client, reply);
+}
+
+void SweepServer::RaiseEvent(event_t event, int arg)
+{
+    switch (event)
+    {
+      case sweep_started_event:
+        streamsweep = deviceIO->Sweep();
+        streamed = 0;
+        reader.Skip();
+        break;
+      case points_event:
+        StreamPoints();
+        break;
+      default:
+        break;
+    }
+}
+
+// Sends the client the points queued since the last batch
+void SweepServer::StreamPoints()
+{
+    MeasuredPoint batch[256];
+    int n;
+
+    while ((n = reader.Read(batch, 256)) > 0)
+    {
+        for (int k=0; k<n && streaming; k++)
+        {
+            if (batch[k].sweep!=streamsweep)
+                continue;
+
+            //Points the reader lost are taken from the scan, it holds them all
+            unsigned int index = batch[k].index;
+            for (; streamed<index && streamed<scan.points.size(); streamed++)
+                StreamPoint(scan.points[streamed], streamed);
+            if (streamed==index)
+                StreamPoint(batch[k].sample, streamed++);
+        }
+    }
+}
+
+void SweepServer::StreamPoint(const Sample &sample, unsigned int index)
+{
+    QJsonObject obj = PointJson(sample, scan.thru);
+    obj["i"] = (int)index;
+    Reply(streaming, obj);
+}
+
+QJsonObject SweepServer::PointJson(const Sample &sample, bool thru)
+{
+    QJsonObject obj;
+
+    obj["f"] = sample.freq;
+    obj["swr"] = sample.swr;
+    obj["z"] = sample.Z;
+    obj["r"] = sample.R;
+    obj["x"] = sample.X;
+    obj["suspect"] = sample.suspect;
+    if (thru)
+    {
+        QJsonObject s21;
+        s21["db"] = sample.S21dB();
+        s21["deg"] = sample.S21deg();
+        obj["s21"] = s21;
+    }
+    return obj;
+}
+
+void SweepServer::Reply(QLocalSocket *client, const QJsonObject &obj)
+{
+    client->write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    client->write("\n", 1);
+}
@@ -0,0 +1,79 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWEEPSERVER_H
+#define SWEEPSERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "eventreceiver.h"
+#include "deviceio.h"
+#include "pointqueue.h"
+
+// Headless owner of the analyzer serving sweeps over a local socket.
+// Requests and replies are single line JSON objects, requests from all
+// clients are executed one at a time in arrival order.
+class SweepServer : public QObject, public EventReceiver
+{
+    Q_OBJECT
+public:
+    explicit SweepServer(QObject *parent = 0);
+    ~SweepServer();
+
+    bool Listen(const QString &name);
+    QString ServerName();
+    void RaiseEvent(event_t event, int arg);
+
+private slots:
+    void Slot_newConnection();
+    void Slot_readyRead();
+
+private:
+    class Request
+    {
+    public:
+        QPointer<QLocalSocket> client;
+        QJsonObject args;
+    };
+
+    void Process();
+    void Execute(Request &req);
+    void Reply(QLocalSocket *client, const QJsonObject &obj);
+    void StreamPoints();
+    void StreamPoint(const Sample &sample, unsigned int index);
+    static QJsonObject PointJson(const Sample &sample, bool thru);
+
+    QLocalServer server;
+    DeviceIO *deviceIO;
+    ScanData scan;
+    QList<Request> pending;
+    PointQueue queue;                   //Points as measured, streamed from here
+    PointQueue::Reader reader;
+    QPointer<QLocalSocket> streaming;   //Client of the sweep in progress
+    unsigned int streamsweep;           //Id of the sweep being streamed
+    unsigned int streamed;              //Points of it already sent
+    bool busy;
+};
+
+#endif // SWEEPSERVER_H
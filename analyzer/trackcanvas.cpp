@@ -0,0 +1,80 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include "trackcanvas.h"
+
+TrackCanvas::TrackCanvas(QWidget *parent) :
+    QFrame(parent)
+{
+    QPen pen1(Qt::black);
+    QFont font("Arial",9);
+
+    pen1.setWidth(0);
+
+    xscale = new GraphScale(&graph, GraphScale::pos_bottom);
+    xscale->pen = pen1;
+    xscale->font = font;
+    xscale->labsuffix = "s";
+    graph.AddItem(xscale);
+
+    yscale1 = new GraphScale(&graph, GraphScale::pos_left);
+    yscale1->pen = pen1;
+    yscale1->font = font;
+    yscale1->title = "Resonance MHz";
+    yscale1->labdps = 4;
+    yscale1->labdiv = 1000000;
+    graph.AddItem(yscale1);
+
+    yscale2 = new GraphScale(&graph, GraphScale::pos_right);
+    yscale2->pen = pen1;
+    yscale2->font = font;
+    yscale2->title = "VSWR";
+    graph.AddItem(yscale2);
+
+    //Points are placed by the time they were recorded
+    freqtrace = new GraphTrace(&graph,yscale1);
+    freqtrace->pen = QPen(Qt::darkGreen,0);
+    freqtrace->xscale = xscale;
+    graph.AddItem(freqtrace);
+
+    swrtrace = new GraphTrace(&graph,yscale2);
+    swrtrace->pen = QPen(Qt::blue,0);
+    swrtrace->xscale = xscale;
+    graph.AddItem(swrtrace);
+}
+
+TrackCanvas::~TrackCanvas()
+{
+    delete xscale;
+    delete yscale1;
+    delete yscale2;
+    delete freqtrace;
+    delete swrtrace;
+}
+
+void TrackCanvas::paintEvent(QPaintEvent *ev)
+{
+    QPainter painter(this);
+
+    graph.Paint(painter,layer,ev->rect());
+    painter.end();
+}
@@ -0,0 +1,46 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKCANVAS_H
+#define TRACKCANVAS_H
+
+#include <QFrame>
+#include <QPixmap>
+
+#include "graph.h"
+
+// Resonant frequency and minimum SWR of a tracking run against time
+class TrackCanvas : public QFrame
+{
+    Q_OBJECT
+public:
+    explicit TrackCanvas(QWidget *parent = 0);
+    ~TrackCanvas();
+
+    Graph graph;
+    GraphScale *xscale, *yscale1, *yscale2;
+    GraphTrace *freqtrace, *swrtrace;
+
+private:
+    void paintEvent(QPaintEvent *ev);
+
+    QPixmap layer;  //Background, axes and labels; redrawn only when the scales or size change
+};
+
+#endif // TRACKCANVAS_H
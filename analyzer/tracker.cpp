@@ -0,0 +1,138 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracker.h"
+
+ResonanceTracker::ResonanceTracker(DeviceIO *device)
+{
+    deviceIO = device;
+    centre = span = span_min = span_max = 0;
+    thinned = 0;
+    points = 50;
+}
+
+bool ResonanceTracker::Sweep(double fstart, double fend, int n, EventReceiver *erx)
+{
+    //At least 1 Hz per step, Cmd_Scan refuses a step that rounds to 0
+    if (fend-fstart < n)
+    {
+        double c = (fstart+fend)/2.0;
+        fstart = c - n/2.0;
+        fend = c + n/2.0;
+    }
+    if (fstart < FMIN) fstart = FMIN;
+    if (fend > FMAX) fend = FMAX;
+
+    scan.freq_start = fstart;
+    scan.freq_end = fend;
+    scan.SetPointCount(n);
+    deviceIO->Cmd_Scan(scan, (long)fstart, (long)fend, (long)((fend-fstart)/n), erx);
+
+    return deviceIO->IsUp() && scan.points.size()>=3;
+}
+
+// Resonance between points by fitting a parabola through the SWR minimum and its neighbours
+double ResonanceTracker::Estimate()
+{
+    int i = scan.swr_min_idx;
+    double f = scan.points[i].freq;
+
+    if (i<=0 || i>=(int)scan.points.size()-1)
+        return f;
+
+    double y0 = scan.points[i-1].swr, y1 = scan.points[i].swr, y2 = scan.points[i+1].swr;
+    double den = y0 - 2*y1 + y2;
+    if (den <= 0)
+        return f;
+
+    double step = scan.points[i+1].freq - f;
+    return f + 0.5*(y0-y2)/den*step;
+}
+
+void ResonanceTracker::Record()
+{
+    TrackPoint p;
+
+    p.t = clock.elapsed()/1000.0;
+    p.freq = centre;
+    p.swr = scan.points[scan.swr_min_idx].swr;
+
+    //A long run keeps its whole time span at half the resolution rather than growing without bound
+    if (history.size()>=MAX_HISTORY)
+    {
+        for (unsigned int i=1;i<history.size()/2;i++)
+            history[i] = history[2*i];
+        history.resize(history.size()/2);
+        thinned++;
+    }
+    history.push_back(p);
+}
+
+bool ResonanceTracker::Locate(double freq_start, double freq_end, int n, EventReceiver *erx)
+{
+    history.clear();
+    thinned = 0;
+
+    if (!Sweep(freq_start, freq_end, n, erx))
+        return false;
+
+    centre = Estimate();
+
+    //Start with twice the measured bandwidth, or a tenth of the range if the match is poor
+    span_max = freq_end - freq_start;
+    if (scan.swr_bw_hi_idx > scan.swr_bw_lo_idx)
+        span = 2*(scan.points[scan.swr_bw_hi_idx].freq - scan.points[scan.swr_bw_lo_idx].freq);
+    else
+        span = span_max/10;
+    if (span > span_max) span = span_max;
+    span_min = span/4;
+    if (span_min < points) span_min = points;
+
+    clock.start();
+    Record();
+    return true;
+}
+
+bool ResonanceTracker::Step(EventReceiver *erx)
+{
+    if (!Sweep(centre-span/2, centre+span/2, points, erx))
+        return false;
+
+    int i = scan.swr_min_idx, n = scan.points.size();
+
+    if (i==0 || i==n-1)
+    {
+        //Ran off the edge, follow it with a wider sweep
+        centre = scan.points[i].freq;
+        span *= 2;
+        if (span > span_max) span = span_max;
+    }
+    else
+    {
+        centre = Estimate();
+        if (i>n/4 && i<n*3/4)
+        {
+            span *= 0.8;
+            if (span < span_min) span = span_min;
+        }
+    }
+
+    Record();
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+(C) Copyright 2015 Jeremy Burton
+
+This file is part of Sark-100-antenna-analyzer.
+
+Sark-100-antenna-analyzer is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+Sark-100-antenna-analyzer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <vector>
+
+#include <QElapsedTimer>
+
+#include "scandata.h"
+#include "deviceio.h"
+
+class TrackPoint
+{
+public:
+    double t;               //Seconds since the resonance was located
+    double freq, swr;       //Resonance estimate and the SWR measured there
+};
+
+// Locates a resonance with one wide sweep, then follows it with narrow
+// sweeps re-centred on the last estimate. The narrow span shrinks while the
+// minimum stays central and doubles when it runs off an edge.
+class ResonanceTracker
+{
+public:
+    ResonanceTracker(DeviceIO *device);
+    bool Locate(double freq_start, double freq_end, int points, EventReceiver *erx);
+    bool Step(EventReceiver *erx);
+
+    ScanData scan;          //Last sweep
+    double centre, span;    //Hz, range of the next narrow sweep
+    int points;             //Points per narrow sweep
+    std::vector<TrackPoint> history;    //At most MAX_HISTORY points over the whole run
+    unsigned int thinned;   //Times history was halved, earlier entries then changed
+
+    static const unsigned int MAX_HISTORY = 4096;
+
+private:
+    bool Sweep(double fstart, double fend, int n, EventReceiver *erx);
+    double Estimate();
+    void Record();
+
+    DeviceIO *deviceIO;
+    double span_min, span_max;
+    QElapsedTimer clock;
+};
+
+#endif // TRACKER_H